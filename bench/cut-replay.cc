@@ -0,0 +1,121 @@
+// repeats the cutting phase of KernelPlaneCut from recorded cut logs (mesh_kernel --record-cuts, see cut-log.hh)
+// no mesh loading, no plane setup and no exact LP thread: only the clipper is measured, deterministically
+// the first run of every log is compared against the recorded plane outcomes
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <rich-log/log.hh>
+
+#include <core/cut-log.hh>
+#include <core/kernel-plane-cut.hh>
+
+namespace
+{
+struct replay_sample
+{
+    std::string log;
+    int planes = 0;
+    int runs = 0;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double p95_ms = 0.0;
+    int kernel_faces = 0;
+    int outcome_mismatches = -1; // -1: the log has no outcomes (small input path logs of version 01)
+};
+
+double percentile(std::vector<double> sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    auto const idx = size_t(p * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+}
+
+int main(int argc, char** args)
+{
+    std::vector<std::string> log_paths;
+    std::string output_path = "cut-replay.csv";
+    int runs = 20;
+    int warmup_runs = 1;
+
+    CLI::App app{"mesh kernel cut replay"};
+    app.add_option("logs", log_paths, "recorded cut logs (.mkcuts)")->required();
+    app.add_option("-o, --output", output_path, "output CSV file");
+    app.add_option("-r, --runs", runs, "timed replays per log");
+    app.add_option("-w, --warmup", warmup_runs, "unmeasured replays per log");
+    CLI11_PARSE(app, argc, args);
+
+    runs = std::max(1, runs);
+
+    Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+    auto failed = false;
+    std::vector<replay_sample> samples;
+    mk::KernelPlaneCut plane_cut;
+    for (auto const& path : log_paths)
+    {
+        mk::cut_log log;
+        if (!mk::load_cut_log(path, log))
+        {
+            std::cerr << "could not read the cut log " << path << std::endl;
+            failed = true;
+            continue;
+        }
+
+        replay_sample sample;
+        sample.log = path;
+        sample.planes = int(log.planes.size());
+        sample.runs = runs;
+
+        // outcomes of the recording, not_processed everywhere in version 01 logs of the small input path
+        auto const has_outcomes = std::any_of(log.outcomes.begin(), log.outcomes.end(), [](auto o) { return o != mk::plane_outcome::not_processed; });
+        plane_cut.replay(log, true);
+        if (has_outcomes)
+        {
+            auto const& replayed = plane_cut.recorded_cut_log().outcomes;
+            sample.outcome_mismatches = 0;
+            for (size_t i = 0; i < log.outcomes.size(); ++i)
+                sample.outcome_mismatches += replayed[i] != log.outcomes[i];
+            failed |= sample.outcome_mismatches > 0;
+        }
+
+        for (auto r = 0; r < warmup_runs; ++r)
+            plane_cut.replay(log);
+
+        std::vector<double> ms;
+        for (auto r = 0; r < runs; ++r)
+        {
+            plane_cut.replay(log);
+            ms.push_back(plane_cut.stats().time_cutting_seconds * 1000.0);
+        }
+        std::sort(ms.begin(), ms.end());
+
+        sample.min_ms = ms.front();
+        sample.median_ms = percentile(ms, 0.5);
+        sample.p95_ms = percentile(ms, 0.95);
+        sample.kernel_faces = plane_cut.has_kernel() ? int(plane_cut.mesh().faces().size()) : 0;
+
+        std::cout << path << ": " << sample.planes << " planes, cutting min " << sample.min_ms << " ms, median " << sample.median_ms << " ms, p95 "
+                  << sample.p95_ms << " ms";
+        if (sample.outcome_mismatches > 0)
+            std::cout << ", " << sample.outcome_mismatches << " plane outcomes differ from the recording";
+        std::cout << std::endl;
+        samples.push_back(sample);
+    }
+
+    std::ofstream out(output_path);
+    out << "log,planes,runs,min_ms,median_ms,p95_ms,kernel_faces,outcome_mismatches\n";
+    for (auto const& s : samples)
+        out << s.log << ',' << s.planes << ',' << s.runs << ',' << s.min_ms << ',' << s.median_ms << ',' << s.p95_ms << ',' << s.kernel_faces << ','
+            << s.outcome_mismatches << '\n';
+
+    return failed ? 1 : 0;
+}
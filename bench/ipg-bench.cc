@@ -0,0 +1,481 @@
+// microbenchmarks for the integer-plane-geometry primitives
+//
+// measures throughput (ns/op over a full operand sweep) and latency percentiles (ns/op per small block)
+// for every geometry typedef in geometry.hh, once with uniformly random and once with adversarial operands.
+// results are written as JSON so changes to the arithmetic core can be compared run-to-run.
+// --verify compares every batched classify backend supported by the cpu bit-exactly against the scalar classify.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include <clean-core/array.hh>
+#include <clean-core/string.hh>
+#include <clean-core/string_view.hh>
+#include <clean-core/vector.hh>
+
+#include <typed-geometry/tg.hh>
+
+#include <CLI/CLI.hpp>
+
+#include <babel-serializer/data/json.hh>
+#include <babel-serializer/file.hh>
+
+#include <integer-plane-geometry/are_parallel.hh>
+#include <integer-plane-geometry/classify.hh>
+#include <integer-plane-geometry/classify_batch.hh>
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/intersect.hh>
+#include <integer-plane-geometry/line.hh>
+#include <integer-plane-geometry/plane.hh>
+#include <integer-plane-geometry/point.hh>
+
+namespace
+{
+struct bench_settings
+{
+    int operands = 4096;
+    int repetitions = 50;
+    int block_size = 32;
+    uint64_t seed = 0x5eed;
+    int verify_planes = 0; // planes per operand set in the batch verification (0 = no verification)
+};
+
+struct bench_result
+{
+    cc::string geometry;
+    cc::string op;
+    cc::string distribution;
+    int64_t ops = 0;
+    double ns_per_op = 0.0; // throughput over all repetitions
+    double ops_per_second = 0.0;
+    double latency_p50_ns = 0.0; // per-op latency, measured per block of block_size ops
+    double latency_p95_ns = 0.0;
+    double latency_p99_ns = 0.0;
+    double latency_max_ns = 0.0;
+};
+
+template <class I>
+void introspect(I&& i, bench_result& r)
+{
+    i(r.geometry, "geometry");
+    i(r.op, "op");
+    i(r.distribution, "distribution");
+    i(r.ops, "ops");
+    i(r.ns_per_op, "ns_per_op");
+    i(r.ops_per_second, "ops_per_second");
+    i(r.latency_p50_ns, "latency_p50_ns");
+    i(r.latency_p95_ns, "latency_p95_ns");
+    i(r.latency_p99_ns, "latency_p99_ns");
+    i(r.latency_max_ns, "latency_max_ns");
+}
+
+/// keeps the compiler from discarding the result of a benchmarked call
+template <class T>
+inline void do_not_optimize(T const& v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&v) : "memory");
+#else
+    static char volatile sink;
+    sink = *reinterpret_cast<char const volatile*>(&v);
+#endif
+}
+
+using bench_clock = std::chrono::steady_clock;
+
+double percentile(cc::vector<double>& values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    auto const idx = std::min(values.size() - 1, size_t(p * double(values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+/// runs f(i) for all i in [0, n) settings.repetitions times
+template <class F>
+bench_result measure(bench_settings const& settings, cc::string_view geometry, cc::string_view op, cc::string_view distribution, int n, F&& f)
+{
+    // warm-up (caches, branch predictors, frequency scaling)
+    for (auto i = 0; i < n; ++i)
+        do_not_optimize(f(i));
+
+    cc::vector<double> block_ns;
+    block_ns.reserve(size_t(settings.repetitions) * (n / settings.block_size + 1));
+
+    auto total_ns = 0.0;
+    for (auto r = 0; r < settings.repetitions; ++r)
+    {
+        for (auto b = 0; b < n; b += settings.block_size)
+        {
+            auto const e = std::min(n, b + settings.block_size);
+            auto const t0 = bench_clock::now();
+            for (auto i = b; i < e; ++i)
+                do_not_optimize(f(i));
+            auto const t1 = bench_clock::now();
+
+            auto const ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            total_ns += ns;
+            block_ns.push_back(ns / (e - b));
+        }
+    }
+
+    bench_result res;
+    res.geometry = geometry;
+    res.op = op;
+    res.distribution = distribution;
+    res.ops = int64_t(n) * settings.repetitions;
+    res.ns_per_op = total_ns / double(res.ops);
+    res.ops_per_second = res.ns_per_op > 0 ? 1e9 / res.ns_per_op : 0.0;
+    res.latency_p50_ns = percentile(block_ns, 0.50);
+    res.latency_p95_ns = percentile(block_ns, 0.95);
+    res.latency_p99_ns = percentile(block_ns, 0.99);
+    res.latency_max_ns = percentile(block_ns, 1.0);
+
+    std::printf("%-22.*s %-22.*s %-12.*s %10.2f ns/op   p50 %8.2f   p99 %8.2f\n", int(geometry.size()), geometry.data(), int(op.size()), op.data(),
+                int(distribution.size()), distribution.data(), res.ns_per_op, res.latency_p50_ns, res.latency_p99_ns);
+
+    return res;
+}
+
+/// classifies all points against planes [0, plane_count) per sweep, reports the time per point/plane predicate
+template <class batch_t, class plane_t>
+bench_result measure_batch(bench_settings const& settings, cc::string_view geometry, cc::string_view op, cc::string_view distribution, batch_t const& batch, cc::vector<plane_t> const& planes, int plane_count)
+{
+    cc::vector<tg::i8> signs;
+    signs.resize(batch.size());
+
+    for (auto i = 0; i < plane_count; ++i) // warm-up
+        batch.classify(planes[i], signs);
+
+    cc::vector<double> call_ns;
+    auto total_ns = 0.0;
+    for (auto r = 0; r < settings.repetitions; ++r)
+        for (auto i = 0; i < plane_count; ++i)
+        {
+            auto const t0 = bench_clock::now();
+            batch.classify(planes[i], signs);
+            do_not_optimize(signs[0]);
+            auto const t1 = bench_clock::now();
+
+            auto const ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+            total_ns += ns;
+            call_ns.push_back(ns / batch.size());
+        }
+
+    bench_result res;
+    res.geometry = geometry;
+    res.op = op;
+    res.distribution = distribution;
+    res.ops = int64_t(batch.size()) * plane_count * settings.repetitions;
+    res.ns_per_op = total_ns / double(res.ops);
+    res.ops_per_second = res.ns_per_op > 0 ? 1e9 / res.ns_per_op : 0.0;
+    res.latency_p50_ns = percentile(call_ns, 0.50);
+    res.latency_p95_ns = percentile(call_ns, 0.95);
+    res.latency_p99_ns = percentile(call_ns, 0.99);
+    res.latency_max_ns = percentile(call_ns, 1.0);
+
+    std::printf("%-22.*s %-22.*s %-12.*s %10.2f ns/op   p50 %8.2f   p99 %8.2f\n", int(geometry.size()), geometry.data(), int(op.size()), op.data(),
+                int(distribution.size()), distribution.data(), res.ns_per_op, res.latency_p50_ns, res.latency_p99_ns);
+
+    return res;
+}
+
+constexpr ipg::batch_backend all_batch_backends[] = {ipg::batch_backend::scalar, ipg::batch_backend::avx2, ipg::batch_backend::avx512_ifma};
+
+/// largest magnitude that is valid for a coordinate / normal of the given bit width
+tg::i64 max_magnitude(int bits) { return bits >= 63 ? std::numeric_limits<tg::i64>::max() : (tg::i64(1) << bits) - 1; }
+
+enum class distribution
+{
+    random,      // uniformly distributed over the valid value range
+    adversarial, // maximal magnitudes, nearly parallel planes, points exactly on planes
+};
+
+/// operand pool for one geometry and one distribution
+template <class geometry_t>
+struct operand_set
+{
+    using plane_t = typename geometry_t::plane_t;
+    using point4_t = typename geometry_t::point4_t;
+    using pos_t = typename geometry_t::pos_t;
+    using line_t = ipg::line<geometry_t>;
+    using normal_scalar_t = typename geometry_t::normal_scalar_t;
+    using pos_scalar_t = typename geometry_t::pos_scalar_t;
+
+    cc::vector<plane_t> planes;
+    cc::vector<point4_t> points;
+    cc::vector<pos_t> positions;
+    cc::vector<line_t> lines;
+    cc::vector<tg::iaabb3> boxes;
+    cc::vector<cc::array<pos_t, 3>> triangles;
+
+    void generate(tg::rng& rng, distribution dist, int n)
+    {
+        auto const pos_max = max_magnitude(geometry_t::bits_position) / 4; // leaves room for the triangle offsets below
+        auto const normal_max = max_magnitude(geometry_t::bits_normal);
+        auto const edge_max = max_magnitude(geometry_t::bits_edge);
+
+        auto const random_scalar = [&](tg::i64 max) -> tg::i64
+        {
+            if (dist == distribution::adversarial)
+                return tg::uniform(rng, 0, 1) == 0 ? -max : max - tg::uniform(rng, tg::i64(0), tg::i64(3));
+            return tg::uniform(rng, -max, max);
+        };
+
+        auto const random_pos = [&] { return pos_t(pos_scalar_t(random_scalar(pos_max)), pos_scalar_t(random_scalar(pos_max)), pos_scalar_t(random_scalar(pos_max))); };
+
+        auto const random_normal = [&]
+        {
+            tg::vec<3, normal_scalar_t> nrm;
+            do
+            {
+                nrm = {normal_scalar_t(random_scalar(normal_max)), normal_scalar_t(random_scalar(normal_max)), normal_scalar_t(random_scalar(normal_max))};
+            } while (nrm == tg::vec<3, normal_scalar_t>::zero);
+            return nrm;
+        };
+
+        planes.clear();
+        points.clear();
+        positions.clear();
+        lines.clear();
+        boxes.clear();
+        triangles.clear();
+
+        for (auto i = 0; i < n; ++i)
+        {
+            auto const nrm = random_normal();
+            auto pl = plane_t::from_pos_normal(random_pos(), nrm);
+            if (dist == distribution::adversarial && i % 2 == 1)
+            {
+                // nearly parallel to the previous plane: maximizes the determinants in intersect
+                pl = planes.back();
+                pl.a = pl.a > 0 ? pl.a - 1 : pl.a + 1;
+                if (!pl.is_valid())
+                    pl.b = 1;
+            }
+            planes.push_back(pl);
+            positions.push_back(random_pos());
+
+            auto const e0 = tg::vec<3, pos_scalar_t>(pos_scalar_t(random_scalar(edge_max)), pos_scalar_t(random_scalar(edge_max)), pos_scalar_t(random_scalar(edge_max)));
+            auto const e1 = tg::vec<3, pos_scalar_t>(pos_scalar_t(random_scalar(edge_max)), pos_scalar_t(random_scalar(edge_max)), pos_scalar_t(random_scalar(edge_max)));
+            auto const p0 = random_pos();
+            triangles.push_back({p0, p0 + e0, p0 + e1});
+
+            if constexpr (geometry_t::bits_position <= 30)
+            {
+                auto const a = tg::ipos3(int(random_scalar(pos_max)), int(random_scalar(pos_max)), int(random_scalar(pos_max)));
+                auto const b = tg::ipos3(int(random_scalar(pos_max)), int(random_scalar(pos_max)), int(random_scalar(pos_max)));
+                boxes.push_back(tg::iaabb3(tg::ipos3(tg::min(a.x, b.x), tg::min(a.y, b.y), tg::min(a.z, b.z)), //
+                                           tg::ipos3(tg::max(a.x, b.x), tg::max(a.y, b.y), tg::max(a.z, b.z))));
+            }
+        }
+
+        for (auto i = 0; i < n; ++i)
+        {
+            auto const& p = planes[i];
+            auto const& q = planes[(i + 1) % n];
+            auto const& r = planes[(i + 2) % n];
+
+            auto l = ipg::intersect(p, q);
+            if (!l.is_valid())
+                l = ipg::intersect(p, r);
+            lines.push_back(l);
+
+            auto pt = ipg::intersect(p, q, r);
+            if (!pt.is_valid())
+                pt = point4_t(tg::ipos3(0, 0, 0));
+            points.push_back(pt);
+        }
+    }
+};
+
+template <class geometry_t>
+void bench_geometry(bench_settings const& settings, cc::string_view name, cc::vector<bench_result>& results)
+{
+    using ops_t = operand_set<geometry_t>;
+    static constexpr int bits_nn = ipg::line<geometry_t>::bits_nn;
+    static constexpr int bits_nd = ipg::line<geometry_t>::bits_nd;
+    static constexpr int bits_classify = 2 + geometry_t::bits_determinant_xxd + geometry_t::bits_normal;
+
+    tg::rng rng;
+    rng.seed(settings.seed);
+
+    auto const n = settings.operands;
+
+    for (auto const dist : {distribution::random, distribution::adversarial})
+    {
+        cc::string_view const dist_name = dist == distribution::random ? "random" : "adversarial";
+
+        ops_t ops;
+        ops.generate(rng, dist, n);
+
+        auto const& planes = ops.planes;
+        auto const& points = ops.points;
+        auto const& positions = ops.positions;
+        auto const& lines = ops.lines;
+        auto const next = [n](int i, int k) { return (i + k) % n; };
+
+        results.push_back(measure(settings, name, "mul_nn", dist_name, n, [&](int i) { return ipg::mul<bits_nn>(planes[i].a, planes[next(i, 1)].b); }));
+        results.push_back(measure(settings, name, "mul_nd", dist_name, n, [&](int i) { return ipg::mul<bits_nd>(planes[i].a, planes[next(i, 1)].d); }));
+        results.push_back(measure(settings, name, "mul_xxd_n", dist_name, n, [&](int i) { return ipg::mul<bits_classify>(points[i].x, planes[next(i, 1)].a); }));
+
+        // classify against a generating plane of a point gives 0: planes[i + 2] is one for every adversarial point
+        results.push_back(measure(settings, name, "classify_point4", dist_name, n,
+                                  [&](int i) { return ipg::classify(points[i], planes[dist == distribution::adversarial ? next(i, 2) : next(i, 7)]); }));
+        results.push_back(measure(settings, name, "classify_pos", dist_name, n, [&](int i) { return ipg::classify(positions[i], planes[next(i, 1)]); }));
+
+        results.push_back(measure(settings, name, "intersect_3_planes", dist_name, n,
+                                  [&](int i) { return ipg::intersect(planes[i], planes[next(i, 1)], planes[next(i, 2)]); }));
+        results.push_back(measure(settings, name, "intersect_2_planes", dist_name, n, [&](int i) { return ipg::intersect(planes[i], planes[next(i, 1)]); }));
+        results.push_back(measure(settings, name, "intersect_line_plane", dist_name, n, [&](int i) { return ipg::intersect(lines[i], planes[next(i, 3)]); }));
+
+        results.push_back(measure(settings, name, "are_parallel_planes", dist_name, n, [&](int i) { return ipg::are_parallel(planes[i], planes[next(i, 1)]); }));
+        results.push_back(measure(settings, name, "are_parallel_line", dist_name, n, [&](int i) { return ipg::are_parallel(planes[i], lines[next(i, 3)]); }));
+
+        results.push_back(measure(settings, name, "from_points_no_gcd", dist_name, n,
+                                  [&](int i)
+                                  {
+                                      auto const& t = ops.triangles[i];
+                                      return geometry_t::plane_t::from_points_no_gcd(t[0], t[1], t[2]);
+                                  }));
+
+        if constexpr (geometry_t::bits_position <= 30)
+        {
+            results.push_back(measure(settings, name, "classify_aabb", dist_name, n, [&](int i) { return ipg::classify(ops.boxes[i], planes[next(i, 1)]); }));
+        }
+
+        // one plane against all points per call, the conversion to limbs is done once and not measured
+        for (auto const backend : all_batch_backends)
+        {
+            if (!ipg::is_supported(backend))
+                continue;
+
+            ipg::point4_batch<geometry_t> batch(backend);
+            batch.assign(points);
+            results.push_back(measure_batch(settings, name, cc::string("classify_point4_batch_") + ipg::to_string(backend), dist_name, batch, planes,
+                                            std::min(n, 64)));
+        }
+    }
+}
+
+/// compares every supported batch backend with the scalar classify, returns the number of mismatches
+template <class geometry_t>
+int verify_geometry(bench_settings const& settings, cc::string_view name)
+{
+    tg::rng rng;
+    rng.seed(settings.seed ^ 0x7e57);
+
+    auto mismatches = 0;
+    for (auto const dist : {distribution::random, distribution::adversarial})
+    {
+        operand_set<geometry_t> ops;
+        ops.generate(rng, dist, settings.operands);
+
+        // negated copies: the sign of w is arbitrary for intersections and must be handled in every backend
+        auto points = ops.points;
+        for (auto i = 0; i < settings.operands; i += 3)
+        {
+            auto p = ops.points[i];
+            p.x = -p.x;
+            p.y = -p.y;
+            p.z = -p.z;
+            p.w = -p.w;
+            points.push_back(p);
+        }
+
+        cc::vector<tg::i8> expected;
+        cc::vector<tg::i8> actual;
+        expected.resize(points.size());
+        actual.resize(points.size());
+
+        for (auto const backend : all_batch_backends)
+        {
+            if (!ipg::is_supported(backend))
+                continue;
+
+            ipg::point4_batch<geometry_t> batch(backend);
+            batch.assign(points);
+
+            auto checked = int64_t(0);
+            for (auto k = 0; k < settings.verify_planes; ++k)
+            {
+                // the first planes generated the points of the adversarial set, so the zero case is covered as well
+                auto const& plane = ops.planes[k % ops.planes.size()];
+                for (size_t i = 0; i < points.size(); ++i)
+                    expected[i] = ipg::classify(points[i], plane);
+                batch.classify(plane, actual);
+
+                for (size_t i = 0; i < points.size(); ++i)
+                {
+                    ++checked;
+                    if (expected[i] == actual[i])
+                        continue;
+
+                    if (mismatches < 10)
+                        std::printf("MISMATCH %.*s %s: plane %d point %d expected %d got %d\n", int(name.size()), name.data(), ipg::to_string(backend), k, int(i),
+                                    int(expected[i]), int(actual[i]));
+                    ++mismatches;
+                }
+            }
+
+            std::printf("verified %-22.*s %-12s %-12s %lld predicates\n", int(name.size()), name.data(), ipg::to_string(backend),
+                        dist == distribution::random ? "random" : "adversarial", (long long)checked);
+        }
+    }
+    return mismatches;
+}
+}
+
+int main(int argc, char** args)
+{
+    bench_settings settings;
+    std::string output_path = "ipg-bench.json";
+
+    CLI::App app{"mesh kernel integer-plane-geometry microbenchmarks"};
+    app.add_option("-o, --output", output_path, "path to the JSON result file");
+    app.add_option("-n, --operands", settings.operands, "number of distinct operands per benchmark");
+    app.add_option("-r, --repetitions", settings.repetitions, "number of sweeps over the operands");
+    app.add_option("-b, --block-size", settings.block_size, "number of ops per latency sample");
+    app.add_option("--seed", settings.seed, "seed of the operand generator");
+    app.add_option("--verify", settings.verify_planes, "only check the batched classify against the scalar one with N random planes per operand set");
+    CLI11_PARSE(app, argc, args);
+
+    settings.operands = std::max(settings.operands, 3);
+    settings.block_size = std::max(settings.block_size, 1);
+
+    if (settings.verify_planes > 0)
+    {
+        auto mismatches = 0;
+        mismatches += verify_geometry<ipg::geometry<26, 55>>(settings, "geometry<26, 55>");
+        mismatches += verify_geometry<ipg::geometry256_x64_n45>(settings, "geometry256_x64_n45");
+        mismatches += verify_geometry<ipg::geometry128_x32_n21>(settings, "geometry128_x32_n21");
+        mismatches += verify_geometry<ipg::geometry256_x48_n49>(settings, "geometry256_x48_n49");
+        mismatches += verify_geometry<ipg::geometry256_x27_n55>(settings, "geometry256_x27_n55");
+        mismatches += verify_geometry<ipg::geometry256_x26_n53>(settings, "geometry256_x26_n53");
+        mismatches += verify_geometry<ipg::geometry192_x19_n39>(settings, "geometry192_x19_n39");
+
+        std::cout << (mismatches == 0 ? "all batch backends agree with the scalar classify" : "batch backends DISAGREE with the scalar classify") << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    cc::vector<bench_result> results;
+
+    bench_geometry<ipg::geometry<26, 55>>(settings, "geometry<26, 55>", results); // used by the kernel computation
+    bench_geometry<ipg::geometry256_x64_n45>(settings, "geometry256_x64_n45", results);
+    bench_geometry<ipg::geometry128_x32_n21>(settings, "geometry128_x32_n21", results);
+    bench_geometry<ipg::geometry256_x48_n49>(settings, "geometry256_x48_n49", results);
+    bench_geometry<ipg::geometry256_x27_n55>(settings, "geometry256_x27_n55", results);
+    bench_geometry<ipg::geometry256_x26_n53>(settings, "geometry256_x26_n53", results);
+    bench_geometry<ipg::geometry192_x19_n39>(settings, "geometry192_x19_n39", results);
+
+    babel::file::write(output_path, babel::json::to_string(results));
+    std::cout << "results written to " << output_path << std::endl;
+
+    return 0;
+}
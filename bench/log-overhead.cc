@@ -0,0 +1,75 @@
+// measures the cost of the hot-path logging and tracing sites in KernelPlaneCut
+// this file is built twice: mesh-kernel-log-overhead uses the configured MK_HOT_PATH_LOG_LEVEL (0 in release builds),
+// mesh-kernel-log-overhead-hot has all hot-path sites compiled in (level 3). the logs are filtered at runtime in both,
+// so the difference of the two timings is the overhead that the compile-time gate removes
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <rich-log/log.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <ctracer/scope.hh>
+
+#include <core/hot-path-log.hh>
+#include <core/kernel-plane-cut.hh>
+
+#include "mesh-generator.hh"
+
+int main(int argc, char** args)
+{
+    int repetitions = 5;
+    bool disable_exact_lp = false;
+    mk::mesh_generator_settings settings;
+    settings.target_faces = 1'000'000;
+    settings.concavity = 0.2;
+    settings.normal_levels = 0;
+
+    CLI::App app{"hot-path logging overhead"};
+    app.add_option("-f, --faces", settings.target_faces, "approximate face count of the synthetic mesh");
+    app.add_option("-c, --concavity", settings.concavity, "fraction of displaced vertices");
+    app.add_option("-r, --repetitions", repetitions, "runs, min and median are reported");
+    app.add_option("--seed", settings.seed, "seed of the generator");
+    app.add_flag("--disable-exact-lp", disable_exact_lp, "disables the parallel exact LP (it can end the cutting early)");
+    CLI11_PARSE(app, argc, args);
+
+    // the sites are filtered at runtime, only their evaluation is measured
+    Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+    pm::Mesh mesh;
+    auto position = pm::vertex_attribute<tg::dpos3>(mesh);
+    mk::generate_mesh(settings, mesh, position);
+
+    auto int_position = pm::vertex_attribute<mk::KernelPlaneCut::pos_t>(mesh);
+    mk::quantize_mesh(position, int_position, mk::KernelPlaneCut::geometry_t::bits_position);
+
+    mk::kernel_options options;
+    options.parallel_exact_lp = !disable_exact_lp;
+
+    std::vector<double> times;
+    std::vector<double> cutting_times;
+    mk::KernelPlaneCut plane_cut;
+    for (auto r = 0; r < std::max(1, repetitions); ++r)
+    {
+        ct::scope s; // do not accumulate traces over the runs
+
+        auto const t0 = std::chrono::steady_clock::now();
+        plane_cut.compute_kernel(int_position, options);
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+        cutting_times.push_back(plane_cut.stats().time_cutting_seconds * 1000.0);
+    }
+
+    std::sort(times.begin(), times.end());
+    std::sort(cutting_times.begin(), cutting_times.end());
+
+    std::printf("hot path level %d, %d faces, %d cutting planes\n", MK_HOT_PATH_LEVEL, int(mesh.faces().size()), plane_cut.stats().total_planes);
+    std::printf("total:   min %10.3f ms, median %10.3f ms\n", times.front(), times[times.size() / 2]);
+    std::printf("cutting: min %10.3f ms, median %10.3f ms\n", cutting_times.front(), cutting_times[cutting_times.size() / 2]);
+    return 0;
+}
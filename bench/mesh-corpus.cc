@@ -0,0 +1,92 @@
+// emits a synthetic corpus of closed meshes with controllable properties
+// every combination of the given parameter lists is written as one OBJ file
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <clean-core/format.hh>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/formats.hh>
+
+#include "mesh-generator.hh"
+
+int main(int argc, char** args)
+{
+    std::string output_path = "corpus";
+    std::vector<std::string> profiles = {"spiky", "stairs", "noisy"};
+    std::vector<int> faces = {20'000};
+    std::vector<double> concavities = {0.1};
+    std::vector<int> levels = {4};
+    std::vector<double> kernel_sizes = {0.5};
+    std::vector<int> coordinate_bits = {26};
+    bool empty_kernel = false;
+    int variants = 1;
+    mk::mesh_generator_settings base;
+
+    CLI::App app{"synthetic mesh corpus generator"};
+    app.add_option("-o, --output", output_path, "output directory");
+    app.add_option("-p, --profile", profiles, "surface profiles: spiky/stairs/noisy")->delimiter(',');
+    app.add_option("-f, --faces", faces, "approximate face counts")->delimiter(',');
+    app.add_option("-c, --concavity", concavities, "fractions of displaced vertices")->delimiter(',');
+    app.add_option("-l, --levels", levels, "displacement levels, bounds the number of distinct normals (0 = continuous)")->delimiter(',');
+    app.add_option("-k, --kernel-size", kernel_sizes, "guaranteed kernel ball radius relative to the mesh")->delimiter(',');
+    app.add_option("-b, --bits", coordinate_bits, "coordinate bit widths")->delimiter(',');
+    app.add_option("-a, --amplitude", base.amplitude, "maximal displacement relative to the mesh");
+    app.add_flag("--empty-kernel", empty_kernel, "additionally emit every configuration with an empty kernel");
+    app.add_option("-n, --variants", variants, "number of random variants per configuration");
+    app.add_option("--seed", base.seed, "base seed");
+    CLI11_PARSE(app, argc, args);
+
+    std::filesystem::create_directories(output_path);
+
+    pm::Mesh mesh;
+    auto position = pm::vertex_attribute<tg::dpos3>(mesh);
+
+    auto count = 0;
+    for (auto const& profile_name : profiles)
+    {
+        auto settings = base;
+        if (!mk::parse_profile(profile_name, settings.profile))
+        {
+            std::cerr << "unknown profile " << profile_name << std::endl;
+            return 1;
+        }
+
+        for (auto const f : faces)
+            for (auto const c : concavities)
+                for (auto const l : levels)
+                    for (auto const k : kernel_sizes)
+                        for (auto const b : coordinate_bits)
+                            for (auto const empty : {false, true})
+                            {
+                                if (empty && !empty_kernel)
+                                    continue;
+
+                                for (auto variant = 0; variant < variants; ++variant)
+                                {
+                                    settings.target_faces = f;
+                                    settings.concavity = c;
+                                    settings.normal_levels = l;
+                                    settings.kernel_size = k;
+                                    settings.coordinate_bits = b;
+                                    settings.empty_kernel = empty;
+                                    settings.seed = base.seed + variant;
+
+                                    mk::generate_mesh(settings, mesh, position);
+
+                                    auto const name = cc::format("%s_f%s_c%s_l%s_k%s_b%s%s_v%s.obj", profile_name, f, c, l, k, b, empty ? "_empty" : "", variant);
+                                    auto const path = (std::filesystem::path(output_path) / name.c_str()).string();
+                                    pm::save(path, position);
+                                    ++count;
+                                }
+                            }
+    }
+
+    std::cout << "wrote " << count << " meshes to " << output_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,271 @@
+#include "mesh-generator.hh"
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+#include <clean-core/array.hh>
+#include <clean-core/assert.hh>
+
+#include <typed-geometry/tg.hh>
+
+namespace
+{
+struct surface_vertex
+{
+    tg::dpos3 base;
+    tg::dvec3 direction; // displacement direction (zero for vertices on cube edges)
+    double offset = 0.0;
+};
+
+tg::dpos3 displaced(surface_vertex const& v) { return v.base + v.direction * v.offset; }
+
+double quantize(double offset, double amplitude, int levels)
+{
+    if (levels <= 0 || amplitude <= 0)
+        return offset;
+    auto const step = amplitude / levels;
+    return std::round(offset / step) * step;
+}
+}
+
+char const* mk::to_string(mesh_profile profile)
+{
+    switch (profile)
+    {
+    case mesh_profile::spiky:
+        return "spiky";
+    case mesh_profile::stairs:
+        return "stairs";
+    case mesh_profile::noisy:
+        return "noisy";
+    }
+    CC_UNREACHABLE("unknown profile");
+}
+
+bool mk::parse_profile(std::string_view name, mesh_profile& profile)
+{
+    for (auto const p : {mesh_profile::spiky, mesh_profile::stairs, mesh_profile::noisy})
+    {
+        if (name == to_string(p))
+        {
+            profile = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+void mk::quantize_mesh(pm::vertex_attribute<tg::dpos3> const& position, pm::vertex_attribute<tg::ipos3>& int_position, int bits_position)
+{
+    auto largest = 0.0;
+    for (auto const v : position.mesh().vertices())
+        for (auto d = 0; d < 3; ++d)
+            largest = tg::max(largest, tg::abs(position[v][d]));
+
+    auto const max_value = (int64_t(1) << bits_position) - 5;
+    auto const factor = max_value / largest;
+    for (auto const v : position.mesh().vertices())
+        int_position[v] = tg::ipos3(position[v] * factor);
+}
+
+void mk::generate_mesh(mesh_generator_settings const& settings, pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position)
+{
+    tg::rng rng;
+    rng.seed(settings.seed);
+
+    // 6 sides * n^2 quads * 2 triangles
+    auto n = tg::max(4, int(std::lround(std::sqrt(settings.target_faces / 12.0))));
+    if (settings.empty_kernel)
+        n = tg::max(n, 32);
+
+    auto const amplitude = tg::clamp(settings.amplitude, 0.0, 4.0);
+    auto const min_offset = -0.9; // never move a vertex across the center
+    auto const kernel_radius = tg::clamp(settings.kernel_size, 0.0, 0.99);
+
+    //* build the subdivided cube
+    // vertices live on the integer lattice [0, n]^3, shared between the sides
+    std::vector<surface_vertex> vertices;
+    std::unordered_map<int64_t, int> vertex_of_lattice;
+    std::vector<cc::array<int, 3>> triangles;
+    // per side: grid vertex index (iu, iv) -> vertex index, used to place the terraces and slots
+    std::vector<std::vector<int>> side_grid(6);
+
+    auto const lattice_vertex = [&](cc::array<int, 3> const& c, int axis, int sign, bool interior) -> int
+    {
+        auto const key = (int64_t(c[0]) * (n + 1) + c[1]) * (n + 1) + c[2];
+        auto const it = vertex_of_lattice.find(key);
+        if (it != vertex_of_lattice.end())
+            return it->second;
+
+        surface_vertex v;
+        v.base = tg::dpos3(-1 + 2.0 * c[0] / n, -1 + 2.0 * c[1] / n, -1 + 2.0 * c[2] / n);
+        if (interior)
+            v.direction[axis] = sign;
+
+        auto const idx = int(vertices.size());
+        vertices.push_back(v);
+        vertex_of_lattice[key] = idx;
+        return idx;
+    };
+
+    for (auto side = 0; side < 6; ++side)
+    {
+        auto const axis = side / 2;
+        auto const sign = side % 2 == 0 ? 1 : -1;
+        auto const u = (axis + 1) % 3;
+        auto const v = (axis + 2) % 3;
+
+        auto& grid = side_grid[side];
+        grid.resize((n + 1) * (n + 1));
+        for (auto iv = 0; iv <= n; ++iv)
+            for (auto iu = 0; iu <= n; ++iu)
+            {
+                cc::array<int, 3> c;
+                c[axis] = sign > 0 ? n : 0;
+                c[u] = iu;
+                c[v] = iv;
+                auto const interior = iu > 0 && iu < n && iv > 0 && iv < n;
+                grid[iv * (n + 1) + iu] = lattice_vertex(c, axis, sign, interior);
+            }
+
+        // cross(e_u, e_v) = e_axis, so (iu, iv) -> (iu + 1, iv) -> (iu + 1, iv + 1) is ccw seen from the positive side
+        for (auto iv = 0; iv < n; ++iv)
+            for (auto iu = 0; iu < n; ++iu)
+            {
+                auto const q0 = grid[iv * (n + 1) + iu];
+                auto const q1 = grid[iv * (n + 1) + iu + 1];
+                auto const q2 = grid[(iv + 1) * (n + 1) + iu + 1];
+                auto const q3 = grid[(iv + 1) * (n + 1) + iu];
+                if (sign > 0)
+                {
+                    triangles.push_back({q0, q1, q2});
+                    triangles.push_back({q0, q2, q3});
+                }
+                else
+                {
+                    triangles.push_back({q0, q2, q1});
+                    triangles.push_back({q0, q3, q2});
+                }
+            }
+    }
+
+    //* displace
+    auto const is_interior = [&](int vi) { return vertices[vi].direction != tg::dvec3::zero; };
+    auto const random_level = [&](double max) { return quantize(tg::uniform(rng, 0.0, max), max, settings.normal_levels); };
+
+    switch (settings.profile)
+    {
+    case mesh_profile::spiky:
+        for (auto vi = 0; vi < int(vertices.size()); ++vi)
+            if (is_interior(vi) && tg::uniform(rng, 0.0, 1.0) < settings.concavity)
+                vertices[vi].offset = tg::max(random_level(amplitude), amplitude / tg::max(1, settings.normal_levels));
+        break;
+
+    case mesh_profile::noisy:
+        for (auto vi = 0; vi < int(vertices.size()); ++vi)
+            if (is_interior(vi) && tg::uniform(rng, 0.0, 1.0) < settings.concavity)
+                vertices[vi].offset = quantize(tg::uniform(rng, -amplitude, amplitude), amplitude, settings.normal_levels);
+        break;
+
+    case mesh_profile::stairs:
+    {
+        // stack random terraces until the requested fraction of vertices is covered
+        auto const interior_count = 6 * (n - 1) * (n - 1);
+        auto covered = 0;
+        std::vector<bool> is_covered(vertices.size(), false);
+        for (auto attempt = 0; covered < settings.concavity * interior_count && attempt < 100 * interior_count; ++attempt)
+        {
+            auto const& grid = side_grid[tg::uniform(rng, 0, 5)];
+            auto const w = tg::uniform(rng, 1, tg::max(1, n / 4));
+            auto const h = tg::uniform(rng, 1, tg::max(1, n / 4));
+            auto const u0 = tg::uniform(rng, 1, n - 1);
+            auto const v0 = tg::uniform(rng, 1, n - 1);
+            auto const step = tg::uniform(rng, 0, 1) == 0 ? random_level(amplitude) : -random_level(amplitude);
+
+            for (auto iv = v0; iv < tg::min(n, v0 + h); ++iv)
+                for (auto iu = u0; iu < tg::min(n, u0 + w); ++iu)
+                {
+                    auto const vi = grid[iv * (n + 1) + iu];
+                    vertices[vi].offset += step;
+                    if (!is_covered[vi])
+                    {
+                        is_covered[vi] = true;
+                        ++covered;
+                    }
+                }
+        }
+        break;
+    }
+    }
+
+    for (auto& v : vertices)
+        v.offset = tg::clamp(v.offset, min_offset, amplitude);
+
+    //* keep a ball of radius kernel_radius inside every face half-space
+    // halving the offsets always terminates: the undisplaced cube has distance 1 to all face planes
+    if (kernel_radius > 0)
+    {
+        for (auto round = 0; round < 64; ++round)
+        {
+            auto any_violation = false;
+            for (auto const& t : triangles)
+            {
+                auto const p0 = displaced(vertices[t[0]]);
+                auto const p1 = displaced(vertices[t[1]]);
+                auto const p2 = displaced(vertices[t[2]]);
+                auto const normal = tg::cross(p1 - p0, p2 - p0);
+                auto const l = tg::length(normal);
+                if (l <= 0)
+                    continue;
+
+                // signed distance of the origin to the inner side of the face plane
+                if (tg::dot(normal, tg::dvec3(p0)) / l >= kernel_radius)
+                    continue;
+
+                any_violation = true;
+                for (auto const vi : t)
+                    vertices[vi].offset = round < 63 ? 0.5 * vertices[vi].offset : 0.0;
+            }
+
+            if (!any_violation)
+                break;
+        }
+    }
+
+    //* two slots on opposite sides that do not overlap in x make the kernel empty
+    if (settings.empty_kernel)
+    {
+        // side 4 = +z, side 5 = -z, both have u = x
+        auto const carve = [&](std::vector<int> const& grid, int column)
+        {
+            for (auto iv = 1; iv < n; ++iv)
+                vertices[grid[iv * (n + 1) + column]].offset = -0.5;
+        };
+        carve(side_grid[4], n / 4);
+        carve(side_grid[5], 3 * n / 4);
+    }
+
+    //* snap to the coordinate grid
+    auto const extent = 1.0 + amplitude;
+    auto const cell = 2 * extent / std::ldexp(1.0, tg::clamp(settings.coordinate_bits, 2, 52));
+
+    mesh.clear();
+    position = pm::vertex_attribute<tg::dpos3>(mesh);
+
+    std::vector<pm::vertex_handle> handles;
+    handles.reserve(vertices.size());
+    for (auto const& v : vertices)
+    {
+        auto p = displaced(v);
+        for (auto d = 0; d < 3; ++d)
+            p[d] = std::round(p[d] / cell) * cell;
+
+        auto const h = mesh.vertices().add();
+        position[h] = p;
+        handles.push_back(h);
+    }
+
+    for (auto const& t : triangles)
+        mesh.faces().add(handles[t[0]], handles[t[1]], handles[t[2]]);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+namespace mk
+{
+/// kind of surface detail that is added to the base cube
+enum class mesh_profile
+{
+    spiky,  // isolated vertices pulled outwards (spiky spheres)
+    stairs, // overlapping raised and lowered rectangular terraces (stair-step CAD parts)
+    noisy,  // random displacement of single vertices (noisy scans)
+};
+
+struct mesh_generator_settings
+{
+    mesh_profile profile = mesh_profile::spiky;
+
+    /// approximate number of triangles, rounded to the closest cube grid resolution
+    int target_faces = 20'000;
+
+    /// fraction of the surface vertices that get displaced, controls the number of concave edges
+    double concavity = 0.1;
+
+    /// number of quantized displacement levels, bounds the number of distinct normals (0 = continuous displacement)
+    int normal_levels = 4;
+
+    /// radius of the ball around the origin that is guaranteed to be inside the kernel, relative to the cube half size
+    /// (0 = no guarantee, the mesh might not be star-shaped)
+    double kernel_size = 0.5;
+
+    /// carves two offset slots into opposite sides so that the kernel is empty
+    /// NOTE: the grid resolution is raised to at least 32 per side, coarser grids cannot guarantee emptiness
+    bool empty_kernel = false;
+
+    /// coordinates are snapped to a grid with 2^coordinate_bits cells along the bounding box diagonal axis
+    int coordinate_bits = 26;
+
+    /// maximal displacement relative to the cube half size
+    double amplitude = 0.5;
+
+    uint64_t seed = 0;
+};
+
+/// generates a closed, outward oriented triangle mesh of genus 0
+/// the mesh is a subdivided cube [-1, 1]^3 whose grid vertices are displaced along the cube face normals
+void generate_mesh(mesh_generator_settings const& settings, pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position);
+
+/// scales the positions to integer coordinates like KernelApp::load_mesh: the largest coordinate is mapped to 2^bits_position - 5
+void quantize_mesh(pm::vertex_attribute<tg::dpos3> const& position, pm::vertex_attribute<tg::ipos3>& int_position, int bits_position);
+
+char const* to_string(mesh_profile profile);
+
+/// returns false if the name does not match any profile
+bool parse_profile(std::string_view name, mesh_profile& profile);
+}
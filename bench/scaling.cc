@@ -0,0 +1,211 @@
+// runs KernelPlaneCut on synthetic meshes and writes scaling curves
+// each parameter of the mesh generator is swept individually around a base configuration,
+// the result is one CSV per parameter with time and peak memory per value
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <rich-log/log.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg.hh>
+
+#include <ctracer/scope.hh>
+
+#include <core/kernel-plane-cut.hh>
+
+#include "mesh-generator.hh"
+
+namespace
+{
+/// resets the peak resident set size of this process (linux only)
+void reset_peak_rss()
+{
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+/// returns the (peak) resident set size in bytes (linux only, 0 otherwise)
+size_t read_rss(bool peak)
+{
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    auto const key = peak ? "VmHWM:" : "VmRSS:";
+    while (std::getline(status, line))
+    {
+        if (line.rfind(key, 0) == 0)
+            return size_t(std::stoull(line.substr(std::string(key).size()))) * 1024;
+    }
+#else
+    (void)peak;
+#endif
+    return 0;
+}
+
+struct scaling_sample
+{
+    std::string parameter;
+    std::string value;
+    mk::mesh_generator_settings settings;
+    int faces = 0;
+    int vertices = 0;
+    double time_ms_min = 0.0;
+    double time_ms_median = 0.0;
+    double rss_before_mb = 0.0;
+    double peak_rss_mb = 0.0;
+    bool has_kernel = false;
+    mk::benchmark_data stats;
+};
+
+scaling_sample run_sample(mk::mesh_generator_settings const& settings, mk::kernel_options const& options, int repetitions)
+{
+    pm::Mesh mesh;
+    auto position = pm::vertex_attribute<tg::dpos3>(mesh);
+    mk::generate_mesh(settings, mesh, position);
+
+    auto int_position = pm::vertex_attribute<mk::KernelPlaneCut::pos_t>(mesh);
+    mk::quantize_mesh(position, int_position, mk::KernelPlaneCut::geometry_t::bits_position);
+
+    scaling_sample sample;
+    sample.settings = settings;
+    sample.faces = mesh.faces().size();
+    sample.vertices = mesh.vertices().size();
+
+    std::vector<double> times;
+    for (auto r = 0; r < repetitions; ++r)
+    {
+        reset_peak_rss();
+        auto const rss_before = read_rss(false);
+
+        ct::scope s; // do not accumulate traces over the runs
+        mk::KernelPlaneCut plane_cut;
+
+        auto const t0 = std::chrono::steady_clock::now();
+        plane_cut.compute_kernel(int_position, options);
+        auto const t1 = std::chrono::steady_clock::now();
+
+        times.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        sample.rss_before_mb = rss_before / (1024.0 * 1024.0);
+        sample.peak_rss_mb = tg::max(sample.peak_rss_mb, read_rss(true) / (1024.0 * 1024.0));
+        sample.stats = plane_cut.stats();
+        sample.has_kernel = plane_cut.has_kernel();
+    }
+
+    std::sort(times.begin(), times.end());
+    sample.time_ms_min = times.front();
+    sample.time_ms_median = times[times.size() / 2];
+    return sample;
+}
+
+void write_csv(std::string const& path, std::vector<scaling_sample> const& samples)
+{
+    std::ofstream out(path);
+    out << "parameter,value,profile,faces,vertices,time_ms_min,time_ms_median,rss_before_mb,peak_rss_mb,peak_delta_mb,"
+           "has_kernel,is_convex,lp_early_out,total_planes,concave_planes,kernel_faces\n";
+    for (auto const& s : samples)
+    {
+        out << s.parameter << ',' << s.value << ',' << mk::to_string(s.settings.profile) << ',' << s.faces << ',' << s.vertices << ',' //
+            << s.time_ms_min << ',' << s.time_ms_median << ',' << s.rss_before_mb << ',' << s.peak_rss_mb << ','                     //
+            << tg::max(0.0, s.peak_rss_mb - s.rss_before_mb) << ','                                                                   //
+            << s.has_kernel << ',' << s.stats.is_convex << ',' << s.stats.lp_early_out << ','                            //
+            << s.stats.total_planes << ',' << s.stats.number_concave_planes << ',' << s.stats.kernel_faces << '\n';
+    }
+}
+}
+
+int main(int argc, char** args)
+{
+    std::string output_path = "scaling";
+    std::string profile_name = "spiky";
+    int repetitions = 3;
+    bool disable_exact_lp = false;
+    mk::mesh_generator_settings base;
+    mk::kernel_options options;
+
+    std::vector<int> faces = {1'000, 4'000, 16'000, 64'000, 256'000, 1'000'000};
+    std::vector<double> concavities = {0.0, 0.01, 0.05, 0.1, 0.25, 0.5};
+    std::vector<int> levels = {1, 2, 4, 8, 0};
+    std::vector<double> kernel_sizes = {0.9, 0.5, 0.25, 0.1, 0.02};
+    std::vector<int> coordinate_bits = {8, 12, 16, 20, 26};
+
+    CLI::App app{"mesh kernel scaling driver"};
+    app.add_option("-o, --output", output_path, "output directory for the CSV files");
+    app.add_option("-p, --profile", profile_name, "surface profile of the base configuration: spiky/stairs/noisy");
+    app.add_option("-r, --repetitions", repetitions, "runs per sample, the median is reported");
+    app.add_option("--base-faces", base.target_faces, "face count of the base configuration");
+    app.add_option("--base-concavity", base.concavity, "concavity of the base configuration");
+    app.add_option("--base-levels", base.normal_levels, "displacement levels of the base configuration");
+    app.add_option("--base-kernel-size", base.kernel_size, "kernel size of the base configuration");
+    app.add_option("--base-bits", base.coordinate_bits, "coordinate bits of the base configuration");
+    app.add_option("--faces", faces, "face count sweep")->delimiter(',');
+    app.add_option("--concavity", concavities, "concavity sweep")->delimiter(',');
+    app.add_option("--levels", levels, "displacement level sweep")->delimiter(',');
+    app.add_option("--kernel-size", kernel_sizes, "kernel size sweep (an empty kernel sample is always added)")->delimiter(',');
+    app.add_option("--bits", coordinate_bits, "coordinate bit width sweep")->delimiter(',');
+    app.add_option("--seed", base.seed, "seed of the generator");
+    app.add_flag("--use-uset", options.use_unordered_set, "use unordered set to store cutting planes");
+    app.add_option("-k, --kdop-k", options.kdop_k, "sets the kdop k (default = 3, aabb)");
+    app.add_flag("--disable-exact-lp", disable_exact_lp, "disables the parallel exact LP");
+    CLI11_PARSE(app, argc, args);
+
+    if (!mk::parse_profile(profile_name, base.profile))
+    {
+        std::cerr << "unknown profile " << profile_name << std::endl;
+        return 1;
+    }
+    options.parallel_exact_lp = !disable_exact_lp;
+    repetitions = std::max(1, repetitions);
+
+    Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+    std::filesystem::create_directories(output_path);
+
+    auto const sweep = [&](std::string const& parameter, auto const& values, auto&& apply)
+    {
+        std::vector<scaling_sample> samples;
+        for (auto const& value : values)
+        {
+            auto settings = base;
+            apply(settings, value);
+
+            auto sample = run_sample(settings, options, repetitions);
+            sample.parameter = parameter;
+            sample.value = std::to_string(value);
+            if (settings.empty_kernel)
+                sample.value = "empty";
+
+            std::cout << parameter << " = " << sample.value << ": " << sample.faces << " faces, " << sample.time_ms_median << " ms, "
+                      << sample.peak_rss_mb << " MB peak" << std::endl;
+            samples.push_back(sample);
+        }
+        write_csv((std::filesystem::path(output_path) / ("scaling_" + parameter + ".csv")).string(), samples);
+    };
+
+    sweep("faces", faces, [](auto& s, int v) { s.target_faces = v; });
+    sweep("concavity", concavities, [](auto& s, double v) { s.concavity = v; });
+    sweep("levels", levels, [](auto& s, int v) { s.normal_levels = v; });
+
+    // a negative value marks the empty kernel sample
+    kernel_sizes.push_back(-1.0);
+    sweep("kernel_size", kernel_sizes,
+          [](auto& s, double v)
+          {
+              s.kernel_size = tg::max(v, 0.0);
+              s.empty_kernel = v < 0;
+          });
+
+    sweep("bits", coordinate_bits, [](auto& s, int v) { s.coordinate_bits = v; });
+    sweep("profile", std::vector<int>{0, 1, 2}, [](auto& s, int v) { s.profile = mk::mesh_profile(v); });
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+// throughput of KernelPlaneCut on many tiny meshes (100 - 2000 faces), the typical workload of asset pipelines
+// every face count is run once with the small input path (SmallPolytope) and once with the full engine,
+// the result is meshes per second and meshes per second per core
+// --verify compares the kernels of both paths on a generated corpus (all profiles, empty kernels, coarse coordinate grids)
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+
+#include <clean-core/set.hh>
+
+#include <rich-log/log.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg.hh>
+
+#include <core/kernel-plane-cut.hh>
+
+#include "mesh-generator.hh"
+
+namespace
+{
+struct input_mesh
+{
+    pm::Mesh mesh;
+    pm::vertex_attribute<mk::KernelPlaneCut::pos_t> position{mesh};
+};
+
+struct throughput_sample
+{
+    int faces = 0;
+    bool small_path = false;
+    int threads = 0;
+    double seconds = 0.0;
+    double meshes_per_second = 0.0;
+    double meshes_per_second_per_core = 0.0;
+    int small_path_meshes = 0; // meshes that actually took the small path (degenerate cuts fall back)
+    int kernels = 0;
+};
+
+/// every thread owns one KernelPlaneCut for all of its meshes, like a batch worker
+throughput_sample run_sample(std::vector<std::unique_ptr<input_mesh>> const& meshes, mk::kernel_options const& options, int threads, int repetitions)
+{
+    throughput_sample sample;
+    sample.threads = threads;
+    sample.small_path = options.small_mesh_max_faces > 0;
+
+    std::vector<int> small_path_meshes(threads, 0);
+    std::vector<int> kernels(threads, 0);
+
+    auto const t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (auto t = 0; t < threads; ++t)
+        workers.emplace_back(
+            [&, t]
+            {
+                mk::KernelPlaneCut plane_cut;
+                for (auto r = 0; r < repetitions; ++r)
+                    for (auto i = size_t(t); i < meshes.size(); i += threads)
+                    {
+                        plane_cut.compute_kernel(meshes[i]->position, options);
+                        if (r == 0)
+                        {
+                            small_path_meshes[t] += plane_cut.stats().small_mesh_path;
+                            kernels[t] += plane_cut.has_kernel();
+                        }
+                    }
+            });
+    for (auto& w : workers)
+        w.join();
+    auto const t1 = std::chrono::steady_clock::now();
+
+    sample.seconds = std::chrono::duration<double>(t1 - t0).count();
+    sample.meshes_per_second = double(meshes.size()) * repetitions / std::max(sample.seconds, 1e-9);
+    sample.meshes_per_second_per_core = sample.meshes_per_second / threads;
+    for (auto t = 0; t < threads; ++t)
+    {
+        sample.small_path_meshes += small_path_meshes[t];
+        sample.kernels += kernels[t];
+    }
+    return sample;
+}
+
+/// emptiness, the input planes of the kernel and the number of box planes of the small path and the full engine
+/// returns false if they differ, meshes on which the small path fell back to the full engine are equal by definition
+bool kernels_agree(mk::KernelPlaneCut const& small, mk::KernelPlaneCut const& full)
+{
+    if (small.has_kernel() != full.has_kernel())
+        return false;
+
+    // box planes are built differently by the two paths (unit normals vs. from points), only their count is comparable
+    auto const split = [](mk::KernelPlaneCut const& plane_cut, cc::set<mk::KernelPlaneCut::plane_t>& input_planes)
+    {
+        auto box_planes = 0;
+        for (auto const& p : plane_cut.kernel_planes())
+            if (p.input_face >= 0)
+                input_planes.add(p.plane);
+            else
+                ++box_planes;
+        return box_planes;
+    };
+
+    cc::set<mk::KernelPlaneCut::plane_t> small_planes;
+    cc::set<mk::KernelPlaneCut::plane_t> full_planes;
+    if (split(small, small_planes) != split(full, full_planes) || small_planes.size() != full_planes.size())
+        return false;
+    for (auto const& p : small_planes)
+        if (!full_planes.contains(p))
+            return false;
+    return true;
+}
+
+/// runs both paths on every profile, with and without an empty kernel and on a fine and a coarse coordinate grid
+/// (coarse grids produce coplanar faces and vertices on cutting planes), returns the number of differing meshes
+int verify_equivalence(mk::mesh_generator_settings const& base, std::vector<int> const& faces, int meshes_per_configuration)
+{
+    mk::KernelPlaneCut small;
+    mk::KernelPlaneCut full;
+    auto mismatches = 0;
+    auto checked = 0;
+    auto fallbacks = 0;
+
+    for (auto const profile : {mk::mesh_profile::spiky, mk::mesh_profile::stairs, mk::mesh_profile::noisy})
+        for (auto const empty_kernel : {false, true})
+            for (auto const coordinate_bits : {26, 8})
+                for (auto const f : faces)
+                    for (auto i = 0; i < meshes_per_configuration; ++i)
+                    {
+                        auto settings = base;
+                        settings.profile = profile;
+                        settings.empty_kernel = empty_kernel;
+                        settings.coordinate_bits = coordinate_bits;
+                        settings.target_faces = f;
+                        settings.seed = base.seed + i;
+
+                        pm::Mesh mesh;
+                        auto position = pm::vertex_attribute<tg::dpos3>(mesh);
+                        auto int_position = pm::vertex_attribute<mk::KernelPlaneCut::pos_t>(mesh);
+                        mk::generate_mesh(settings, mesh, position);
+                        mk::quantize_mesh(position, int_position, mk::KernelPlaneCut::geometry_t::bits_position);
+
+                        mk::kernel_options small_options;
+                        small_options.small_mesh_max_faces = int(mesh.faces().size());
+                        mk::kernel_options full_options;
+                        full_options.small_mesh_max_faces = 0;
+
+                        small.compute_kernel(int_position, small_options);
+                        full.compute_kernel(int_position, full_options);
+
+                        ++checked;
+                        fallbacks += !small.stats().small_mesh_path;
+                        if (kernels_agree(small, full))
+                            continue;
+
+                        if (mismatches < 10)
+                            std::cout << "MISMATCH " << mk::to_string(profile) << (empty_kernel ? " empty kernel" : "") << ", " << coordinate_bits
+                                      << " bits, " << mesh.faces().size() << " faces, seed " << settings.seed << ": small path "
+                                      << (small.has_kernel() ? "has a kernel" : "is empty") << ", full engine "
+                                      << (full.has_kernel() ? "has a kernel" : "is empty") << std::endl;
+                        ++mismatches;
+                    }
+
+    std::cout << "verified " << checked << " meshes (" << fallbacks << " fell back to the full engine), " << mismatches << " differ" << std::endl;
+    return mismatches;
+}
+}
+
+int main(int argc, char** args)
+{
+    std::string output_path = "small-mesh-throughput.csv";
+    std::string profile_name = "noisy";
+    int mesh_count = 256;
+    int repetitions = 4;
+    int threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    mk::mesh_generator_settings base;
+    base.concavity = 0.05;
+
+    std::vector<int> faces = {100, 250, 500, 1'000, 2'000};
+    int verify_meshes = 0;
+
+    CLI::App app{"mesh kernel small mesh throughput"};
+    app.add_option("-o, --output", output_path, "output CSV file");
+    app.add_option("-p, --profile", profile_name, "surface profile of the meshes: spiky/stairs/noisy");
+    app.add_option("-n, --meshes", mesh_count, "number of distinct meshes per face count");
+    app.add_option("-r, --repetitions", repetitions, "passes over all meshes");
+    app.add_option("-t, --threads", threads, "worker threads, one KernelPlaneCut each");
+    app.add_option("--faces", faces, "face counts")->delimiter(',');
+    app.add_option("--concavity", base.concavity, "concavity of the meshes");
+    app.add_option("--seed", base.seed, "seed of the first mesh");
+    app.add_option("--verify", verify_meshes, "only compare the kernels of both paths on N meshes per profile, kernel and grid configuration");
+    CLI11_PARSE(app, argc, args);
+
+    if (!mk::parse_profile(profile_name, base.profile))
+    {
+        std::cerr << "unknown profile " << profile_name << std::endl;
+        return 1;
+    }
+    threads = std::max(1, threads);
+    repetitions = std::max(1, repetitions);
+
+    Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+    if (verify_meshes > 0)
+    {
+        auto const mismatches = verify_equivalence(base, faces, verify_meshes);
+        std::cout << (mismatches == 0 ? "the small input path agrees with the full engine" : "the small input path DISAGREES with the full engine") << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
+
+    std::vector<throughput_sample> samples;
+    for (auto const f : faces)
+    {
+        std::vector<std::unique_ptr<input_mesh>> meshes;
+        auto actual_faces = 0;
+        for (auto i = 0; i < mesh_count; ++i)
+        {
+            auto settings = base;
+            settings.target_faces = f;
+            settings.seed = base.seed + i;
+
+            auto input = std::make_unique<input_mesh>();
+            auto position = pm::vertex_attribute<tg::dpos3>(input->mesh);
+            mk::generate_mesh(settings, input->mesh, position);
+            mk::quantize_mesh(position, input->position, mk::KernelPlaneCut::geometry_t::bits_position);
+            actual_faces = input->mesh.faces().size();
+            meshes.push_back(std::move(input));
+        }
+
+        for (auto const small_path : {true, false})
+        {
+            mk::kernel_options options;
+            options.small_mesh_max_faces = small_path ? std::max(actual_faces, options.small_mesh_max_faces) : 0;
+
+            auto sample = run_sample(meshes, options, threads, repetitions);
+            sample.faces = actual_faces;
+            std::cout << sample.faces << " faces, " << (small_path ? "small path" : "full engine") << ": " << sample.meshes_per_second
+                      << " meshes/s, " << sample.meshes_per_second_per_core << " meshes/s/core (" << sample.small_path_meshes << "/"
+                      << meshes.size() << " on the small path)" << std::endl;
+            samples.push_back(sample);
+        }
+    }
+
+    std::ofstream out(output_path);
+    out << "faces,small_path,threads,seconds,meshes_per_second,meshes_per_second_per_core,small_path_meshes,kernels\n";
+    for (auto const& s : samples)
+        out << s.faces << ',' << s.small_path << ',' << s.threads << ',' << s.seconds << ',' << s.meshes_per_second << ','
+            << s.meshes_per_second_per_core << ',' << s.small_path_meshes << ',' << s.kernels << '\n';
+
+    return 0;
+}
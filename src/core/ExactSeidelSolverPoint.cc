@@ -1,5 +1,7 @@
 #include "ExactSeidelSolverPoint.hh"
 
+#include <algorithm>
+
 #include <rich-log/log.hh>
 
 #include <integer-plane-geometry/any_point.hh>
@@ -27,6 +29,16 @@ int orientation(ipg::line<geometry_t> const& line, ipg::plane<geometry_t> const&
 
     return tg::sign(dot);
 }
+
+cc::array<int, 3> indices_of(mk::ExactSeidelSolverPoint::solution const& s) { return {s.plane_idx_0, s.plane_idx_1, s.plane_idx_2}; }
+
+/// true if the half-spaces of the given planes have an empty intersection
+bool has_empty_intersection(cc::span<mk::ExactSeidelSolverPoint::plane_t const> planes)
+{
+    mk::ExactSeidelSolverPoint solver;
+    solver.set_planes(planes);
+    return solver.solve() == mk::ExactSeidelSolverPoint::state::infeasible;
+}
 }
 
 void mk::ExactSeidelSolverPoint::set_planes(cc::span<plane_t const> planes)
@@ -67,6 +79,7 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_3D_problem(c
     {
         if (m_should_stop)
         {
+            m_was_stopped = true;
             return state::infeasible; // might not actually be infeasible, but does not matter at this point
         }
 
@@ -112,6 +125,7 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_3D_problem(c
         }
 
         // solution not valid anymore, solve 2d problem
+        m_basis_3d = indices_of(m_solution);
         auto state_2d = solve_2D_problem(planes.first(pi), pi);
         if (state_2d == state::infeasible)
             return state::infeasible;
@@ -124,6 +138,7 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_3D_problem(c
 mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_2D_problem(cc::span<plane_t const> planes, int fixed_plane_3D_idx)
 {
     m_solution.reset();
+    m_fixed_3d = fixed_plane_3D_idx;
     auto const fixed_plane = m_planes[fixed_plane_3D_idx];
     m_solution.append(fixed_plane_3D_idx, fixed_plane);
 
@@ -131,6 +146,7 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_2D_problem(c
     {
         if ((pi + 1) % 1000 == 0 && m_should_stop)
         {
+            m_was_stopped = true;
             return state::infeasible; // might not actually be infeasible, but takes the direct return path
         }
 
@@ -171,13 +187,20 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_2D_problem(c
             }
         }
 
+        m_basis_2d = indices_of(m_solution);
+
         if (ipg::are_parallel(plane, fixed_plane))
         {
             if (ipg::classify(ipg::any_point(fixed_plane), plane) == 1)
+            {
+                m_fixed_2d = -1;
+                m_conflict = {pi, -1, -1};
                 return state::infeasible;
+            }
         }
 
         // line solution not valid anymore, build 1d solution
+        m_fixed_2d = pi;
         auto state_1d = solve_1D_problem(cc::span(m_planes).first(pi), fixed_plane_3D_idx, pi);
         if (state_1d == state::infeasible)
             return state::infeasible;
@@ -216,36 +239,36 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_1D_problem(c
             CC_ASSERT(interval.left_orientation != interval.right_orientation);
             CC_ASSERT(interval.left_orientation != 0);
             CC_ASSERT(interval.right_orientation != 0);
-            // check both interval bounds
-            auto const c_left = ipg::classify(interval.left_point, plane);
-            auto const c_right = ipg::classify(interval.right_point, plane);
 
-            if (c_left == 1)
+            // the orientation (line direction times normal) is much narrower than a classification of a bound (i256 times i64)
+            // a plane can only cut off the bound of its own orientation alone, the other bound is only classified if that one is cut off
+            auto const o = orientation(m_solution.line, plane);
+            if (o == 0)
             {
-                if (c_right == 1)
+                // parallel to line, both bounds are on the same side
+                if (ipg::classify(interval.left_point, plane) == 1)
                 {
+                    m_conflict = {pi, interval.left_idx, interval.right_idx};
                     return state::infeasible;
                 }
-                else
-                {
-                    // update left interval
-                    interval.left_idx = pi;
-                    interval.left_point = ipg::intersect(m_solution.line, plane);
-                    CC_ASSERT(interval.left_orientation == orientation(m_solution.line, plane));
-                }
+                continue;
             }
-            else
+
+            auto const is_left = o == interval.left_orientation;
+            if (ipg::classify(is_left ? interval.left_point : interval.right_point, plane) <= 0)
+                continue; // noop, interval is still valid
+
+            if (ipg::classify(is_left ? interval.right_point : interval.left_point, plane) == 1)
             {
-                CC_ASSERT(c_left <= 0);
-                if (c_right == 1)
-                {
-                    // update right interval
-                    interval.right_idx = pi;
-                    interval.right_point = ipg::intersect(m_solution.line, plane);
-                    CC_ASSERT(interval.right_orientation == orientation(m_solution.line, plane));
-                }
-                // else noop, interval is still valid
+                m_conflict = {pi, interval.left_idx, interval.right_idx};
+                return state::infeasible;
             }
+
+            // update the bound of the same orientation
+            auto& idx = is_left ? interval.left_idx : interval.right_idx;
+            auto& point = is_left ? interval.left_point : interval.right_point;
+            idx = pi;
+            point = ipg::intersect(m_solution.line, plane);
         }
         else if (interval.is_one_sided())
         {
@@ -256,7 +279,10 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_1D_problem(c
             {
                 // parallel to line
                 if (c > 0)
+                {
+                    m_conflict = {pi, -1, -1};
                     return state::infeasible;
+                }
             }
             else if (c == 1)
             {
@@ -269,6 +295,7 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_1D_problem(c
                 }
                 else
                 {
+                    m_conflict = {pi, interval.left_idx, -1};
                     return state::infeasible;
                 }
             }
@@ -290,7 +317,10 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_1D_problem(c
                 // parallel
                 auto const c = ipg::classify(ipg::any_point(m_solution.line), plane);
                 if (c == 1)
+                {
+                    m_conflict = {pi, -1, -1};
                     return state::infeasible;
+                }
             }
             else
             {
@@ -311,6 +341,63 @@ mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve_1D_problem(c
 
 mk::ExactSeidelSolverPoint::state mk::ExactSeidelSolverPoint::solve()
 {
-    m_should_stop = false;
+    // m_should_stop is not cleared here: a stop() issued before the solver thread started must not get lost
+    m_basis_3d = {-1, -1, -1};
+    m_basis_2d = {-1, -1, -1};
+    m_fixed_3d = -1;
+    m_fixed_2d = -1;
+    m_conflict = {-1, -1, -1};
+    m_was_stopped = false;
     return solve_3D_problem(m_planes);
 }
+
+cc::vector<int> mk::ExactSeidelSolverPoint::infeasible_subset() const
+{
+    if (m_was_stopped || m_conflict[0] < 0)
+        return {};
+
+    //* candidates: everything that took part in the final conflict
+    cc::vector<int> candidates;
+    auto const add = [&](int idx)
+    {
+        if (idx >= 0 && std::find(candidates.begin(), candidates.end(), idx) == candidates.end())
+            candidates.push_back(idx);
+    };
+    add(m_fixed_3d);
+    add(m_fixed_2d);
+    for (auto const idx : m_conflict)
+        add(idx);
+    for (auto const idx : m_basis_2d)
+        add(idx);
+    for (auto const idx : m_basis_3d)
+        add(idx);
+
+    auto const planes_of = [&](cc::span<int const> indices)
+    {
+        cc::vector<plane_t> planes;
+        for (auto const idx : indices)
+            planes.push_back(m_planes[idx]);
+        return planes;
+    };
+
+    if (!has_empty_intersection(planes_of(candidates)))
+        return {};
+
+    //* deletion filter: drop every plane that is not needed, leaves an irreducible subset (at most 4 planes in 3D)
+    for (size_t k = 0; k < candidates.size();)
+    {
+        cc::vector<int> trial;
+        for (size_t j = 0; j < candidates.size(); ++j)
+            if (j != k)
+                trial.push_back(candidates[j]);
+
+        if (has_empty_intersection(planes_of(trial)))
+            candidates = std::move(trial);
+        else
+            ++k;
+    }
+
+    for (auto& idx : candidates)
+        idx = m_mapping[idx];
+    return candidates;
+}
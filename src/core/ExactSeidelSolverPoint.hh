@@ -104,18 +104,35 @@ public: // API
 
     solution const& get_solution() { return m_solution; }
 
+    /// once solve() returned infeasible: indices (into the planes given to set_planes) of at most four planes
+    /// whose half-spaces alone have an empty intersection
+    /// empty if the solver was stopped or the subset could not be confirmed
+    /// the candidates are the planes involved in the final conflict, they are checked and minimized with tiny solves
+    cc::vector<int> infeasible_subset() const;
+
     void stop() { m_should_stop = true; }
 
+    /// clears a previous stop(), must not be called while solve() is running
+    void reset_stop() { m_should_stop = false; }
+
 private: // member
     // state m_state = state::ambiguous;
     tg::rng m_rng;
     cc::vector<int> m_mapping;
     cc::vector<plane_t> m_planes;
 
-    std::atomic<bool> m_should_stop;
+    std::atomic<bool> m_should_stop = false;
 
     solution m_solution;
 
+    //* planes involved in the last conflict, indices into m_planes
+    cc::array<int, 3> m_basis_3d = {-1, -1, -1}; // 3D solution that was violated by m_fixed_3d
+    cc::array<int, 3> m_basis_2d = {-1, -1, -1}; // 2D solution that was violated by m_fixed_2d (or the conflicting plane)
+    int m_fixed_3d = -1;
+    int m_fixed_2d = -1;
+    cc::array<int, 3> m_conflict = {-1, -1, -1}; // violating plane and the interval bounds it conflicts with
+    bool m_was_stopped = false;
+
 private: // helper methods
     state solve_3D_problem(cc::span<plane_t const> planes);
 
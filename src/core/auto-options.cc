@@ -0,0 +1,263 @@
+#include "auto-options.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <unordered_set>
+
+#include <clean-core/format.hh>
+
+#include <rich-log/log.hh>
+
+#include <typed-geometry/tg.hh>
+
+// internal
+#include <core/option-overrides.hh>
+
+namespace
+{
+struct normal_hash
+{
+    size_t operator()(tg::i64vec3 const& n) const
+    {
+        auto h = size_t(n.x);
+        h = h * 0x9E3779B97F4A7C15ull ^ size_t(n.y);
+        h = h * 0x9E3779B97F4A7C15ull ^ size_t(n.z);
+        return h;
+    }
+};
+
+/// integer normal of the first three vertices, divided by the gcd of its components
+/// differences of 26 bit coordinates: the cross product fits into 64 bit
+tg::i64vec3 reduced_normal(tg::ipos3 const& p0, tg::ipos3 const& p1, tg::ipos3 const& p2)
+{
+    auto const n = tg::cross(tg::i64vec3(p1 - p0), tg::i64vec3(p2 - p0));
+    auto const g = std::gcd(std::gcd(n.x, n.y), n.z);
+    return g == 0 ? n : n / g;
+}
+
+bool in_range(double v, double min, double max) { return v >= min && (max < 0 || v <= max); }
+
+/// the bucket bounds of the calibration
+constexpr int face_bounds[] = {0, 2'000, 20'000, 200'000};
+constexpr double concave_bounds[] = {0.0, 0.05, 0.2};
+}
+
+mk::input_statistics mk::compute_input_statistics(pm::vertex_attribute<tg::ipos3> const& positions)
+{
+    auto const& mesh = positions.mesh();
+
+    input_statistics stats;
+    stats.faces = int(mesh.faces().size());
+
+    auto max_coordinate = int64_t(0);
+    for (auto const v : mesh.vertices())
+    {
+        auto const p = positions[v];
+        max_coordinate = tg::max(max_coordinate, tg::max(tg::abs(int64_t(p.x)), tg::max(tg::abs(int64_t(p.y)), tg::abs(int64_t(p.z)))));
+    }
+    while ((int64_t(1) << stats.coordinate_bits) <= max_coordinate)
+        stats.coordinate_bits++;
+
+    pm::face_attribute<tg::i64vec3> normal(mesh);
+    std::unordered_set<tg::i64vec3, normal_hash> normals;
+    for (auto const f : mesh.faces())
+    {
+        auto const h = f.any_halfedge();
+        normal[f] = reduced_normal(positions[h.vertex_from()], positions[h.vertex_to()], positions[h.next().vertex_to()]);
+        normals.insert(normal[f]);
+    }
+    stats.distinct_normals = int(normals.size());
+
+    // concave: the far vertex of one face is above the plane of the other
+    auto interior_edges = 0;
+    auto concave_edges = 0;
+    for (auto const e : mesh.edges())
+    {
+        if (e.is_boundary())
+            continue;
+
+        auto const h = e.halfedgeA();
+        auto const n = tg::dvec3(normal[h.face()]);
+        auto const far = positions[h.opposite().next().vertex_to()];
+        interior_edges++;
+        if (tg::dot(n, tg::dvec3(far - positions[h.vertex_from()])) > 0)
+            concave_edges++;
+    }
+    stats.concave_edge_fraction = interior_edges > 0 ? double(concave_edges) / interior_edges : 0.0;
+
+    return stats;
+}
+
+bool mk::matches(auto_rule const& rule, input_statistics const& stats)
+{
+    return in_range(stats.faces, rule.min_faces, rule.max_faces)                                                    //
+           && in_range(stats.concave_edge_fraction, rule.min_concave_edge_fraction, rule.max_concave_edge_fraction) //
+           && in_range(stats.distinct_normals, rule.min_distinct_normals, rule.max_distinct_normals);
+}
+
+cc::vector<mk::auto_rule> mk::default_auto_rules()
+{
+    cc::vector<auto_rule> rules;
+
+    // the exact LP thread costs more than it saves on tiny inputs
+    rules.push_back({"tiny", 0, 2'000, 0.0, -1.0, 0, -1, "parallel_exact_lp=0"});
+
+    // many distinct normals: many cutting planes survive, a tighter bounding volume culls more of them
+    rules.push_back({"many_normals", 0, -1, 0.0, -1.0, 2'000, -1, "kdop_k=8"});
+
+    // large inputs: parallel setup pays off earlier than the default threshold
+    rules.push_back({"large", 200'000, -1, 0.0, -1.0, 0, -1, "min_faces_for_parallel_setup=50000"});
+
+    return rules;
+}
+
+cc::vector<cc::string> mk::apply_auto_rules(cc::span<auto_rule const> rules, input_statistics const& stats, kernel_options& options)
+{
+    cc::vector<cc::string> applied;
+    for (auto const& rule : rules)
+    {
+        if (!matches(rule, stats))
+            continue;
+
+        auto candidate = options;
+        std::string error;
+        if (!apply_overrides(std::string_view(rule.overrides.data(), rule.overrides.size()), candidate, &error))
+        {
+            LOGD(Default, Warning, "auto rule '%s' skipped: %s", rule.name, error);
+            continue;
+        }
+
+        options = candidate;
+        applied.push_back(rule.name);
+    }
+    return applied;
+}
+
+bool mk::save_auto_rules(std::string const& path, cc::span<auto_rule const> rules)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    out << "# name min_faces max_faces min_concave max_concave min_normals max_normals overrides\n";
+    for (auto const& r : rules)
+    {
+        out << r.name.c_str() << ' ' << r.min_faces << ' ' << r.max_faces << ' ' << r.min_concave_edge_fraction << ' ' << r.max_concave_edge_fraction
+            << ' ' << r.min_distinct_normals << ' ' << r.max_distinct_normals << ' ' << (r.overrides.empty() ? "-" : r.overrides.c_str()) << '\n';
+    }
+    return bool(out);
+}
+
+bool mk::load_auto_rules(std::string const& path, cc::vector<auto_rule>& rules)
+{
+    rules.clear();
+
+    std::ifstream in(path);
+    if (!in)
+        return false;
+
+    std::string line;
+    while (std::getline(in, line))
+    {
+        auto const comment = line.find('#');
+        if (comment != std::string::npos)
+            line.resize(comment);
+
+        std::istringstream fields(line);
+        std::string name, overrides;
+        auto_rule r;
+        if (!(fields >> name))
+            continue; // empty line
+
+        if (!(fields >> r.min_faces >> r.max_faces >> r.min_concave_edge_fraction >> r.max_concave_edge_fraction >> r.min_distinct_normals
+              >> r.max_distinct_normals >> overrides))
+        {
+            LOGD(Default, Error, "malformed auto rule '%s' in %s", line, path);
+            return false;
+        }
+
+        r.name = name.c_str();
+        r.overrides = overrides == "-" ? "" : overrides.c_str();
+        rules.push_back(r);
+    }
+    return true;
+}
+
+mk::AutoCalibration::AutoCalibration()
+{
+    auto const face_count = int(std::size(face_bounds));
+    auto const concave_count = int(std::size(concave_bounds));
+    for (auto f = 0; f < face_count; ++f)
+        for (auto c = 0; c < concave_count; ++c)
+        {
+            auto& b = m_buckets.emplace_back();
+            b.bounds.min_faces = face_bounds[f] + (f > 0 ? 1 : 0);
+            b.bounds.max_faces = f + 1 < face_count ? face_bounds[f + 1] : -1;
+            b.bounds.min_concave_edge_fraction = concave_bounds[c];
+            b.bounds.max_concave_edge_fraction = c + 1 < concave_count ? concave_bounds[c + 1] : -1.0;
+            b.bounds.name = cc::format("faces_%s_concave_%s", f, c);
+            b.relative_time_sum.resize(candidate_overrides().size(), 0.0);
+        }
+}
+
+cc::vector<cc::string> mk::AutoCalibration::candidate_overrides()
+{
+    return {
+        "",
+        "kdop_k=8",
+        "kdop_k=12",
+        "use_unordered_set=1",
+        "parallel_exact_lp=0",
+        "min_faces_for_parallel_setup=50000",
+    };
+}
+
+void mk::AutoCalibration::add(input_statistics const& stats, cc::span<double const> candidate_ms)
+{
+    CC_ASSERT(candidate_ms.size() == candidate_overrides().size());
+    if (candidate_ms[0] <= 0.0)
+        return;
+
+    for (auto& b : m_buckets)
+    {
+        // the buckets overlap at their bounds, the first one wins
+        if (!matches(b.bounds, stats))
+            continue;
+
+        // relative to the base options: large meshes do not dominate the bucket
+        for (size_t i = 0; i < candidate_ms.size(); ++i)
+            b.relative_time_sum[i] += candidate_ms[i] / candidate_ms[0];
+        b.meshes++;
+        return;
+    }
+}
+
+cc::vector<mk::auto_rule> mk::AutoCalibration::derive_rules(double min_gain) const
+{
+    auto const candidates = candidate_overrides();
+
+    cc::vector<auto_rule> rules;
+    for (auto const& b : m_buckets)
+    {
+        if (b.meshes == 0)
+            continue;
+
+        size_t best = 0;
+        for (size_t i = 1; i < candidates.size(); ++i)
+            if (b.relative_time_sum[i] < b.relative_time_sum[best])
+                best = i;
+
+        auto const mean = b.relative_time_sum[best] / b.meshes;
+        LOGD(Default, Info, "[calibrate] %s: %s meshes, best '%s' at %s of the base time", b.bounds.name, b.meshes, candidates[best], mean);
+        if (best == 0 || mean > 1.0 - min_gain)
+            continue;
+
+        auto rule = b.bounds;
+        rule.overrides = candidates[best];
+        rules.push_back(rule);
+    }
+    return rules;
+}
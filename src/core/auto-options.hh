@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+
+#include <clean-core/span.hh>
+#include <clean-core/string.hh>
+#include <clean-core/vector.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+// internal
+#include <core/options.hh>
+
+namespace mk
+{
+/// cheap statistics of an input mesh that predict which kernel_options are fast (one pass over faces and edges)
+struct input_statistics
+{
+    int faces = 0;
+    double concave_edge_fraction = 0.0; // concave edges / interior edges, computed in double (only a statistic)
+    int distinct_normals = 0;           // distinct integer face normals after dividing by their gcd
+    int coordinate_bits = 0;            // bits of the largest absolute quantized coordinate
+};
+
+template <class I>
+void introspect(I&& i, input_statistics& s)
+{
+    i(s.faces, "faces");
+    i(s.concave_edge_fraction, "concave_edge_fraction");
+    i(s.distinct_normals, "distinct_normals");
+    i(s.coordinate_bits, "coordinate_bits");
+}
+
+input_statistics compute_input_statistics(pm::vertex_attribute<tg::ipos3> const& positions);
+
+/// one row of the rule table: the overrides are applied if all bounds hold (inclusive, a negative max is unbounded)
+struct auto_rule
+{
+    cc::string name;
+    int min_faces = 0;
+    int max_faces = -1;
+    double min_concave_edge_fraction = 0.0;
+    double max_concave_edge_fraction = -1.0;
+    int min_distinct_normals = 0;
+    int max_distinct_normals = -1;
+    cc::string overrides; // "key=value,..." of kernel_options, see option-overrides.hh
+};
+
+bool matches(auto_rule const& rule, input_statistics const& stats);
+
+/// rules used by --auto without --auto-rules, hand-tuned on the synthetic corpus (see mesh-kernel-corpus)
+cc::vector<auto_rule> default_auto_rules();
+
+/// applies all matching rules in table order (later rules win), returns the names of the applied rules
+/// rules with invalid overrides are skipped and logged
+cc::vector<cc::string> apply_auto_rules(cc::span<auto_rule const> rules, input_statistics const& stats, kernel_options& options);
+
+/// text format, one rule per line, '#' starts a comment:
+///   name min_faces max_faces min_concave max_concave min_normals max_normals overrides
+/// (overrides must not contain spaces, "-" for none)
+bool save_auto_rules(std::string const& path, cc::span<auto_rule const> rules);
+bool load_auto_rules(std::string const& path, cc::vector<auto_rule>& rules);
+
+/// what --auto chose for one input, written as <name>_auto_options.json next to <name>_options.json
+struct auto_options_record
+{
+    input_statistics statistics;
+    cc::vector<cc::string> applied_rules;
+    kernel_options options;
+};
+
+template <class I>
+void introspect(I&& i, auto_options_record& r)
+{
+    i(r.statistics, "statistics");
+    i(r.applied_rules, "applied_rules");
+    i(r.options, "options");
+}
+
+/// derives a rule table from timings of candidate option sets on a corpus
+/// the meshes are grouped into buckets by face count and concave edge fraction, every bucket gets the candidate with the
+/// lowest mean time relative to the base options (if it is faster by at least min_gain)
+class AutoCalibration
+{
+public:
+    AutoCalibration();
+
+    /// overrides compared against the base options, the first entry is the base itself ("")
+    static cc::vector<cc::string> candidate_overrides();
+
+    /// median compute time of every candidate (same order as candidate_overrides) for one mesh
+    void add(input_statistics const& stats, cc::span<double const> candidate_ms);
+
+    cc::vector<auto_rule> derive_rules(double min_gain = 0.03) const;
+
+private:
+    struct bucket
+    {
+        auto_rule bounds; // overrides unused
+        cc::vector<double> relative_time_sum;
+        int meshes = 0;
+    };
+    cc::vector<bucket> m_buckets;
+};
+}
@@ -0,0 +1,62 @@
+#include "background-worker.hh"
+
+mk::BackgroundWorker::BackgroundWorker() { m_thread = std::thread([this] { run(); }); }
+
+mk::BackgroundWorker::~BackgroundWorker()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shutdown = true;
+        m_pending = nullptr;
+        if (m_running_cancelled)
+            *m_running_cancelled = true;
+    }
+    m_cv.notify_one();
+    m_thread.join();
+}
+
+void mk::BackgroundWorker::submit(task t)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_pending = std::move(t);
+        if (m_running_cancelled)
+            *m_running_cancelled = true;
+        m_busy = true;
+    }
+    m_cv.notify_one();
+}
+
+void mk::BackgroundWorker::cancel()
+{
+    std::lock_guard lock(m_mutex);
+    m_pending = nullptr;
+    if (m_running_cancelled)
+        *m_running_cancelled = true;
+}
+
+void mk::BackgroundWorker::run()
+{
+    while (true)
+    {
+        task current;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        {
+            std::unique_lock lock(m_mutex);
+            m_running_cancelled = nullptr;
+            if (!m_pending)
+                m_busy = false;
+
+            m_cv.wait(lock, [this] { return m_shutdown || m_pending; });
+            if (m_shutdown)
+                return;
+
+            current = std::move(m_pending);
+            m_pending = nullptr;
+            cancelled = std::make_shared<std::atomic<bool>>(false);
+            m_running_cancelled = cancelled;
+        }
+
+        current(*cancelled);
+    }
+}
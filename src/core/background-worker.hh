@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mk
+{
+/// single worker thread that runs the latest submitted task
+/// submitting a task cancels the running one and replaces a pending one that did not start yet
+/// tasks receive a cancellation flag that they are expected to poll (e.g. via KernelPlaneCut::set_stop_token)
+class BackgroundWorker
+{
+public:
+    using task = std::function<void(std::atomic<bool> const& cancelled)>;
+
+    BackgroundWorker();
+    ~BackgroundWorker();
+
+    BackgroundWorker(BackgroundWorker const&) = delete;
+    BackgroundWorker& operator=(BackgroundWorker const&) = delete;
+
+    void submit(task t);
+
+    /// cancels the running and the pending task
+    void cancel();
+
+    /// true while a task is running or pending
+    bool is_busy() const { return m_busy.load(std::memory_order_acquire); }
+
+private:
+    void run();
+
+private:
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    task m_pending;
+    std::shared_ptr<std::atomic<bool>> m_running_cancelled; // flag of the running task
+    std::atomic<bool> m_busy = false;
+    bool m_shutdown = false;
+};
+}
@@ -1,7 +1,26 @@
 #pragma once
 
+#include <cstdint>
+
 namespace mk
 {
+/// what a cutting plane did during the cutting phase
+enum class plane_outcome : uint8_t
+{
+    not_processed, // the computation ended before the plane (empty kernel, early out, cancelled)
+    culled,        // rejected by the bounding volume test
+    redundant,     // processed but did not cut anything off
+    cut,
+};
+
+/// cost of one cutting plane, recorded with kernel_options::record_plane_costs
+struct plane_cost
+{
+    int input_face = -1; // index of the input face generating the plane
+    float seconds = 0.0f;
+    plane_outcome outcome = plane_outcome::not_processed;
+};
+
 struct benchmark_data
 {
     int input_faces = 0;
@@ -10,10 +29,28 @@ struct benchmark_data
     int concave_contribution_kernel = 0;
     bool is_convex = false;
     bool lp_early_out = false;
+    bool small_mesh_path = false;
     int number_concave_planes = 0;
     int total_planes = 0;
+    int culled_planes = 0;      // rejected by the bounding volume test
+    int marching_fallbacks = 0; // cuts where marching hit its iteration bound and the full scan clip was used
+    bool clip_failed = false;   // the full scan clip found no closed cap, the run stopped and has no valid kernel
+
+    // kernel_options::min_kernel_volume > 0 only, in the coordinates passed to KernelPlaneCut::compute_kernel
+    double kernel_volume = 0.0;
+    double kernel_inradius_bound = 0.0; // 3 * volume / area, no ball of a larger radius fits into the kernel
+    bool kernel_too_small = false;      // the volume is below min_kernel_volume, the kernel is reported as empty
 
     double time_plane_orracle_seconds = 0.0;
+
+    // wall clock time of the phases of KernelPlaneCut::compute_kernel
+    double time_input_planes_seconds = 0.0;
+    double time_edge_state_seconds = 0.0;
+    double time_cutting_planes_seconds = 0.0;
+    double time_supporting_structure_seconds = 0.0;
+    double time_cutting_seconds = 0.0;
+    double time_finalize_seconds = 0.0;
+    double time_total_seconds = 0.0;
 };
 
 template <class I>
@@ -25,8 +62,22 @@ void introspect(I&& i, benchmark_data& data)
     i(data.concave_contribution_kernel, "concave_contribution_kernel");
     i(data.is_convex, "is_convex");
     i(data.lp_early_out, "lp_early_out");
+    i(data.small_mesh_path, "small_mesh_path");
     i(data.number_concave_planes, "number_concave_planes");
     i(data.total_planes, "total_planes");
+    i(data.culled_planes, "culled_planes");
+    i(data.marching_fallbacks, "marching_fallbacks");
+    i(data.clip_failed, "clip_failed");
+    i(data.kernel_volume, "kernel_volume");
+    i(data.kernel_inradius_bound, "kernel_inradius_bound");
+    i(data.kernel_too_small, "kernel_too_small");
     i(data.time_plane_orracle_seconds, "time_plane_orracle_seconds");
+    i(data.time_input_planes_seconds, "time_input_planes_seconds");
+    i(data.time_edge_state_seconds, "time_edge_state_seconds");
+    i(data.time_cutting_planes_seconds, "time_cutting_planes_seconds");
+    i(data.time_supporting_structure_seconds, "time_supporting_structure_seconds");
+    i(data.time_cutting_seconds, "time_cutting_seconds");
+    i(data.time_finalize_seconds, "time_finalize_seconds");
+    i(data.time_total_seconds, "time_total_seconds");
 }
 }
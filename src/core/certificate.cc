@@ -0,0 +1,94 @@
+#include "certificate.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+
+// internal
+#include <core/ExactSeidelSolverPoint.hh>
+
+namespace
+{
+constexpr char certificate_magic[8] = {'M', 'K', 'C', 'E', 'R', 'T', '0', '1'};
+}
+
+bool mk::save_certificate(std::string const& path, cc::span<int const> faces, int input_face_count)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    auto const face_count = uint32_t(input_face_count);
+    auto const n = uint32_t(faces.size());
+    out.write(certificate_magic, sizeof(certificate_magic));
+    out.write(reinterpret_cast<char const*>(&face_count), sizeof(face_count));
+    out.write(reinterpret_cast<char const*>(&n), sizeof(n));
+    for (auto const f : faces)
+    {
+        auto const idx = int32_t(f);
+        out.write(reinterpret_cast<char const*>(&idx), sizeof(idx));
+    }
+    return bool(out);
+}
+
+bool mk::load_certificate(std::string const& path, std::vector<int>& faces)
+{
+    faces.clear();
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(certificate_magic)];
+    uint32_t face_count = 0;
+    uint32_t n = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, certificate_magic, sizeof(magic)) != 0)
+        return false;
+    if (!in.read(reinterpret_cast<char*>(&face_count), sizeof(face_count)) || !in.read(reinterpret_cast<char*>(&n), sizeof(n)))
+        return false;
+    if (n == 0 || n > 4)
+        return false;
+
+    for (auto i = 0u; i < n; ++i)
+    {
+        int32_t idx = -1;
+        if (!in.read(reinterpret_cast<char*>(&idx), sizeof(idx)))
+            return false;
+        faces.push_back(idx);
+    }
+    return true;
+}
+
+bool mk::certificate_holds(pm::vertex_attribute<tg::ipos3> const& positions, cc::span<int const> faces)
+{
+    using plane_t = ExactSeidelSolverPoint::plane_t;
+
+    auto const& mesh = positions.mesh();
+    if (faces.empty())
+        return false;
+
+    cc::vector<plane_t> planes;
+    for (auto const idx : faces)
+    {
+        if (idx < 0 || idx >= int(mesh.all_faces().size()))
+            return false;
+
+        auto const f = mesh.faces()[idx];
+        if (f.is_removed())
+            return false;
+
+        // same plane construction as the kernel computation (first three vertices)
+        auto const vertices = f.vertices().to_vector();
+        if (vertices.size() < 3)
+            return false;
+
+        auto const plane = plane_t::from_points_no_gcd(positions[vertices[0]], positions[vertices[1]], positions[vertices[2]]);
+        if (tg::is_zero(plane.a) && tg::is_zero(plane.b) && tg::is_zero(plane.c))
+            return false;
+        planes.push_back(plane);
+    }
+
+    ExactSeidelSolverPoint solver;
+    solver.set_planes(planes);
+    return solver.solve() == ExactSeidelSolverPoint::state::infeasible;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <clean-core/span.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+namespace mk
+{
+/// proof that a mesh has an empty kernel: at most four input faces whose planes alone have an empty intersection
+/// (see ExactSeidelSolverPoint::infeasible_subset and KernelPlaneCut::infeasibility_certificate)
+///
+/// binary file: "MKCERT01", u32 input face count, u32 number of faces, i32 face indices, little endian
+bool save_certificate(std::string const& path, cc::span<int const> faces, int input_face_count);
+
+/// returns false if the file does not exist or is not a certificate
+bool load_certificate(std::string const& path, std::vector<int>& faces);
+
+/// true if all faces still exist and their planes (recomputed from the current positions) still have an empty intersection
+/// a handful of planes: constant time, independent of the mesh size
+/// edits elsewhere in the mesh do not matter, the certificate only depends on its own faces
+bool certificate_holds(pm::vertex_attribute<tg::ipos3> const& positions, cc::span<int const> faces);
+}
@@ -0,0 +1,162 @@
+#include "cut-log.hh"
+
+#include <cstring>
+#include <fstream>
+
+#include <clean-core/assert.hh>
+
+#include <rich-log/log.hh>
+
+namespace
+{
+constexpr char cut_log_magic[8] = {'M', 'K', 'C', 'U', 'T', 'S', '0', '2'};
+
+// version 01 has no small_mesh_path flag, its small input path logs have no outcomes
+constexpr char cut_log_magic_01[8] = {'M', 'K', 'C', 'U', 'T', 'S', '0', '1'};
+
+using plane_t = mk::cut_log::plane_t;
+
+static_assert(sizeof(mk::cut_log::pos_t::scalar_t) == 4, "positions are stored as i32");
+static_assert(sizeof(plane_t::normal_scalar_t) == 8, "normals are stored as i64");
+static_assert(sizeof(plane_t::distance_t) == 16, "distances are stored as i128");
+
+template <class T>
+void write_value(std::ofstream& out, T const& v)
+{
+    out.write(reinterpret_cast<char const*>(&v), sizeof(T));
+}
+
+template <class T>
+bool read_value(std::ifstream& in, T& v)
+{
+    return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+
+char const* to_string(mk::plane_outcome outcome)
+{
+    switch (outcome)
+    {
+    case mk::plane_outcome::not_processed:
+        return "not processed";
+    case mk::plane_outcome::culled:
+        return "culled";
+    case mk::plane_outcome::redundant:
+        return "redundant";
+    case mk::plane_outcome::cut:
+        return "cut";
+    }
+    return "unknown";
+}
+}
+
+bool mk::save_cut_log(std::string const& path, cut_log const& log)
+{
+    CC_ASSERT(log.planes.size() == log.input_faces.size() && log.planes.size() == log.outcomes.size());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    out.write(cut_log_magic, sizeof(cut_log_magic));
+    write_value(out, uint8_t(log.use_bb_culling));
+    write_value(out, int32_t(log.kdop_k));
+    write_value(out, uint8_t(log.small_mesh_path));
+    for (auto i = 0; i < 3; ++i)
+        write_value(out, log.box_min[i]);
+    for (auto i = 0; i < 3; ++i)
+        write_value(out, log.box_max[i]);
+
+    write_value(out, uint32_t(log.planes.size()));
+    write_value(out, int32_t(log.number_concave_planes));
+    write_value(out, int32_t(log.lp_early_out_plane));
+
+    for (size_t i = 0; i < log.planes.size(); ++i)
+    {
+        auto const& p = log.planes[i];
+        write_value(out, p.a);
+        write_value(out, p.b);
+        write_value(out, p.c);
+        write_value(out, p.d);
+        write_value(out, int32_t(log.input_faces[i]));
+        write_value(out, uint8_t(log.outcomes[i]));
+    }
+    return bool(out);
+}
+
+bool mk::load_cut_log(std::string const& path, cut_log& log)
+{
+    log = {};
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(cut_log_magic)];
+    if (!in.read(magic, sizeof(magic)))
+        return false;
+    auto const is_01 = std::memcmp(magic, cut_log_magic_01, sizeof(magic)) == 0;
+    if (!is_01 && std::memcmp(magic, cut_log_magic, sizeof(magic)) != 0)
+        return false;
+
+    uint8_t use_bb_culling = 0;
+    int32_t kdop_k = 0;
+    int32_t cut_batch_size = 0; // version 01 only, the batching mode was removed
+    uint8_t small_mesh_path = 0;
+    if (!read_value(in, use_bb_culling) || !read_value(in, kdop_k))
+        return false;
+    if (is_01 ? !read_value(in, cut_batch_size) : !read_value(in, small_mesh_path))
+        return false;
+    log.use_bb_culling = use_bb_culling != 0;
+    log.kdop_k = kdop_k;
+    log.small_mesh_path = small_mesh_path != 0;
+
+    for (auto i = 0; i < 3; ++i)
+        if (!read_value(in, log.box_min[i]))
+            return false;
+    for (auto i = 0; i < 3; ++i)
+        if (!read_value(in, log.box_max[i]))
+            return false;
+
+    uint32_t plane_count = 0;
+    int32_t number_concave_planes = 0;
+    int32_t lp_early_out_plane = -1;
+    if (!read_value(in, plane_count) || !read_value(in, number_concave_planes) || !read_value(in, lp_early_out_plane))
+        return false;
+    if (number_concave_planes < 0 || uint32_t(number_concave_planes) > plane_count)
+        return false;
+    log.number_concave_planes = number_concave_planes;
+    log.lp_early_out_plane = lp_early_out_plane;
+
+    log.planes.reserve(plane_count);
+    log.input_faces.reserve(plane_count);
+    log.outcomes.reserve(plane_count);
+    for (auto i = 0u; i < plane_count; ++i)
+    {
+        plane_t p;
+        int32_t input_face = -1;
+        uint8_t outcome = 0;
+        if (!read_value(in, p.a) || !read_value(in, p.b) || !read_value(in, p.c) || !read_value(in, p.d) || //
+            !read_value(in, input_face) || !read_value(in, outcome))
+            return false;
+        if (outcome > uint8_t(plane_outcome::cut))
+            return false;
+
+        log.planes.push_back(p);
+        log.input_faces.push_back(input_face);
+        log.outcomes.push_back(plane_outcome(outcome));
+    }
+    return true;
+}
+
+cc::vector<mk::cut_operation> mk::RecentCuts::entries() const
+{
+    cc::vector<cut_operation> result;
+    auto const n = m_count < capacity ? m_count : capacity;
+    for (auto i = m_count - n; i < m_count; ++i)
+        result.push_back(m_entries[i % capacity]);
+    return result;
+}
+
+void mk::RecentCuts::dump(char const* reason) const
+{
+    LOGD(Default, Warning, "%s, the last %s of %s cuts:", reason, m_count < capacity ? m_count : capacity, m_count);
+    for (auto const& op : entries())
+        LOGD(Default, Warning, "  plane %s: %s, %s vertices, %s faces", op.plane, to_string(op.outcome), op.vertices, op.faces);
+}
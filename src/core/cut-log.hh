@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include <clean-core/vector.hh>
+
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+// internal
+#include <core/benchmark_data.hh>
+#include <core/options.hh>
+
+namespace mk
+{
+/// everything the clipper of KernelPlaneCut (compute_mesh_kernel) consumes, recorded with kernel_options::record_cut_log
+/// KernelPlaneCut::replay repeats the cutting phase from it without the input mesh, the plane setup and the exact LP thread
+struct cut_log
+{
+    using geometry_t = ipg::geometry<26, 55>;
+    using pos_t = typename geometry_t::pos_t;
+    using plane_t = typename geometry_t::plane_t;
+
+    /// the options the clipper reads (bounding volume culling)
+    bool use_bb_culling = true;
+    int kdop_k = 3;
+
+    /// the planes were clipped by the small input path (SmallPolytope), replay uses it as well
+    bool small_mesh_path = false;
+
+    /// the initial polytope is this box (aabb of the input)
+    pos_t box_min;
+    pos_t box_max;
+
+    /// planes that reached the clipper in cutting order, the first number_concave_planes are concave
+    cc::vector<plane_t> planes;
+    cc::vector<int> input_faces; // index of the input face generating each plane
+    int number_concave_planes = 0;
+
+    /// what each plane did
+    cc::vector<plane_outcome> outcomes;
+
+    /// index of the plane before which the exact LP reported an empty kernel, -1 if it did not finish in time
+    int lp_early_out_plane = -1;
+};
+
+/// binary file, little endian:
+///   "MKCUTS02", u8 use_bb_culling, i32 kdop_k, u8 small_mesh_path, 3 x i32 box_min, 3 x i32 box_max,
+///   u32 plane count, i32 number_concave_planes, i32 lp_early_out_plane,
+///   per plane: 3 x i64 normal, 16 byte i128 distance (two's complement), i32 input face, u8 outcome
+bool save_cut_log(std::string const& path, cut_log const& log);
+
+/// returns false if the file does not exist or is not a cut log
+bool load_cut_log(std::string const& path, cut_log& log);
+
+/// one processed plane of the clipper
+struct cut_operation
+{
+    int plane = -1;
+    plane_outcome outcome = plane_outcome::not_processed;
+    int vertices = 0; // vertices of the polytope after the plane
+    int faces = 0;
+};
+
+/// the most recent operations of the clipper for post-mortem dumps, the oldest entry is overwritten
+/// fixed size, recording is a few stores per plane and always enabled
+class RecentCuts
+{
+public:
+    static constexpr size_t capacity = 64;
+
+    void clear() { m_count = 0; }
+
+    void push(cut_operation const& op)
+    {
+        m_entries[m_count % capacity] = op;
+        ++m_count;
+    }
+
+    /// number of operations pushed since the last clear (including overwritten ones)
+    size_t total() const { return m_count; }
+
+    /// oldest first
+    cc::vector<cut_operation> entries() const;
+
+    /// logs the entries as warnings
+    void dump(char const* reason) const;
+
+private:
+    std::array<cut_operation, capacity> m_entries;
+    size_t m_count = 0;
+};
+}
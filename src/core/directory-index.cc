@@ -0,0 +1,275 @@
+#include "directory-index.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+namespace
+{
+bool is_mesh_extension(std::filesystem::path const& ext) { return ext == ".obj" || ext == ".off" || ext == ".stl"; }
+
+/// "OFF" (or COFF, NOFF, ...) followed by "#vertices #faces #edges", comments start with #
+int64_t read_off_face_count(std::filesystem::path const& path)
+{
+    std::ifstream in(path);
+    std::string token;
+    auto header_found = false;
+    auto values_read = 0;
+    int64_t values[2] = {-1, -1};
+    while (values_read < 2 && in >> token)
+    {
+        if (token[0] == '#')
+        {
+            std::getline(in, token);
+            continue;
+        }
+
+        if (!header_found)
+        {
+            if (token.size() < 3 || token.compare(token.size() - 3, 3, "OFF") != 0)
+                return -1;
+            header_found = true;
+            continue;
+        }
+
+        char* end = nullptr;
+        values[values_read++] = std::strtoll(token.c_str(), &end, 10);
+        if (*end != '\0')
+            return -1;
+    }
+    return values_read == 2 ? values[1] : -1;
+}
+
+/// binary stl: 80 byte header, u32 triangle count, 50 bytes per triangle
+/// files whose size does not match are treated as ascii (unknown face count)
+int64_t read_stl_face_count(std::filesystem::path const& path, uint64_t size_bytes)
+{
+    if (size_bytes < 84)
+        return -1;
+
+    std::ifstream in(path, std::ios::binary);
+    char header[84];
+    if (!in.read(header, sizeof(header)))
+        return -1;
+
+    uint32_t triangles = 0;
+    std::memcpy(&triangles, header + 80, sizeof(triangles));
+    return 84 + 50 * uint64_t(triangles) == size_bytes ? int64_t(triangles) : -1;
+}
+
+int64_t read_face_count(std::filesystem::path const& path, uint64_t size_bytes)
+{
+    auto const ext = path.extension();
+    if (ext == ".off")
+        return read_off_face_count(path);
+    if (ext == ".stl")
+        return read_stl_face_count(path, size_bytes);
+    return -1; // obj has no header, counting would mean parsing the whole file
+}
+
+bool contains_case_insensitive(std::string_view text, std::string_view pattern)
+{
+    auto const it = std::search(text.begin(), text.end(), pattern.begin(), pattern.end(),
+                                [](char a, char b) { return std::tolower((unsigned char)a) == std::tolower((unsigned char)b); });
+    return it != text.end();
+}
+}
+
+void mk::DirectoryIndex::scan(std::string const& directory)
+{
+    m_directory = directory;
+
+    uint64_t generation;
+    {
+        std::lock_guard lock(m_mutex);
+        generation = ++m_scan_generation;
+        m_entries.clear();
+        m_modification_times.clear();
+    }
+    request_view();
+
+    m_scan_worker.submit(
+        [this, directory, generation](std::atomic<bool> const& cancelled)
+        {
+            using clock = std::chrono::steady_clock;
+            auto const publish_interval = std::chrono::milliseconds(100);
+
+            //* pass 1: names, sizes and cached metadata
+            file_list batch;
+            std::vector<int64_t> batch_times;
+            auto last_publish = clock::now();
+
+            auto const flush = [&]
+            {
+                if (!append_entries(generation, batch, batch_times))
+                    return false;
+                batch.clear();
+                batch_times.clear();
+                request_view();
+                last_publish = clock::now();
+                return true;
+            };
+
+            std::error_code ec;
+            auto it = std::filesystem::directory_iterator(directory, ec);
+            for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+            {
+                if (cancelled)
+                    return;
+
+                auto const& entry = *it;
+                std::error_code entry_ec;
+                if (!entry.is_regular_file(entry_ec) || !is_mesh_extension(entry.path().extension()))
+                    continue;
+
+                file_entry e;
+                e.name = entry.path().filename().string();
+                e.size_bytes = entry.file_size(entry_ec);
+                auto const mtime = int64_t(entry.last_write_time(entry_ec).time_since_epoch().count());
+
+                {
+                    std::lock_guard lock(m_mutex);
+                    auto const cached = m_metadata_cache.find(entry.path().string());
+                    if (cached != m_metadata_cache.end() && cached->second.size_bytes == e.size_bytes && cached->second.modification_time == mtime)
+                        e.face_count = cached->second.face_count;
+                }
+
+                batch.push_back(std::move(e));
+                batch_times.push_back(mtime);
+
+                if (clock::now() - last_publish > publish_interval && !flush())
+                    return;
+            }
+            if (!flush())
+                return;
+
+            //* pass 2: face counts from the file headers
+            file_list snapshot;
+            {
+                std::lock_guard lock(m_mutex);
+                snapshot = m_entries;
+            }
+
+            auto updated = false;
+            for (size_t i = 0; i < snapshot.size(); ++i)
+            {
+                if (cancelled)
+                    return;
+
+                auto const& e = snapshot[i];
+                auto const path = std::filesystem::path(directory) / e.name;
+                auto const ext = path.extension();
+                if (e.face_count >= 0 || ext == ".obj")
+                    continue;
+
+                auto const faces = read_face_count(path, e.size_bytes);
+
+                {
+                    std::lock_guard lock(m_mutex);
+                    if (generation != m_scan_generation)
+                        return;
+                    m_entries[i].face_count = faces;
+                    m_metadata_cache[path.string()] = {e.size_bytes, m_modification_times[i], faces};
+                }
+                updated = true;
+
+                if (clock::now() - last_publish > publish_interval)
+                {
+                    request_view();
+                    last_publish = clock::now();
+                    updated = false;
+                }
+            }
+
+            if (updated)
+                request_view();
+        });
+}
+
+bool mk::DirectoryIndex::append_entries(uint64_t generation, file_list& entries, std::vector<int64_t> const& modification_times)
+{
+    std::lock_guard lock(m_mutex);
+    if (generation != m_scan_generation)
+        return false;
+
+    m_modification_times.insert(m_modification_times.end(), modification_times.begin(), modification_times.end());
+    m_entries.insert(m_entries.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+    return true;
+}
+
+void mk::DirectoryIndex::set_view_settings(file_view_settings const& settings)
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_view_settings = settings;
+    }
+    request_view();
+}
+
+std::shared_ptr<mk::file_list const> mk::DirectoryIndex::view() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_view;
+}
+
+size_t mk::DirectoryIndex::file_count() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_entries.size();
+}
+
+void mk::DirectoryIndex::request_view()
+{
+    // the rebuild ignores the cancellation flag: during a scan new requests arrive faster than a large view is sorted,
+    // a pending request is replaced instead so that at most one rebuild is queued
+    m_view_worker.submit(
+        [this](std::atomic<bool> const&)
+        {
+            file_list entries;
+            file_view_settings settings;
+            uint64_t generation;
+            {
+                std::lock_guard lock(m_mutex);
+                settings = m_view_settings;
+                generation = m_scan_generation;
+                entries.reserve(m_entries.size());
+                for (auto const& e : m_entries)
+                    if (settings.filter.empty() || contains_case_insensitive(e.name, settings.filter))
+                        entries.push_back(e);
+            }
+
+            auto const key_less = [&](file_entry const& a, file_entry const& b)
+            {
+                switch (settings.sort)
+                {
+                case file_sort::size:
+                    if (a.size_bytes != b.size_bytes)
+                        return a.size_bytes < b.size_bytes;
+                    break;
+                case file_sort::faces:
+                    if (a.face_count != b.face_count)
+                        return a.face_count < b.face_count;
+                    break;
+                case file_sort::name:
+                    break;
+                }
+                return a.name < b.name;
+            };
+
+            std::sort(entries.begin(), entries.end(),
+                      [&](file_entry const& a, file_entry const& b) { return settings.descending ? key_less(b, a) : key_less(a, b); });
+
+            auto view = std::make_shared<file_list const>(std::move(entries));
+            {
+                std::lock_guard lock(m_mutex);
+                if (generation != m_scan_generation)
+                    return; // a newer scan already requested its own view
+                m_view = std::move(view);
+            }
+            m_version.fetch_add(1, std::memory_order_release);
+        });
+}
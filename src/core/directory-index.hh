@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// internal
+#include <core/background-worker.hh>
+
+namespace mk
+{
+struct file_entry
+{
+    std::string name; // file name without directory
+    uint64_t size_bytes = 0;
+    int64_t face_count = -1; // -1 if unknown (obj files, ascii stl, not read yet)
+};
+
+enum class file_sort
+{
+    name,
+    size,
+    faces,
+};
+
+struct file_view_settings
+{
+    std::string filter; // case-insensitive substring of the name, empty = all
+    file_sort sort = file_sort::name;
+    bool descending = false;
+};
+
+using file_list = std::vector<file_entry>;
+
+/// indexes the mesh files (obj/off/stl) of a directory in the background
+/// the listing is published incrementally while scanning, the face counts are read from the file headers in a second pass
+/// filtering and sorting happen on a worker thread, the ui only fetches the resulting view
+/// metadata is cached per path (invalidated by size and modification time) and survives rescans
+class DirectoryIndex
+{
+public:
+    /// starts scanning the directory, cancels a running scan
+    void scan(std::string const& directory);
+
+    /// changes filter and sort order, the view is rebuilt in the background
+    void set_view_settings(file_view_settings const& settings);
+
+    /// filtered and sorted entries, never null
+    std::shared_ptr<file_list const> view() const;
+
+    /// incremented every time a new view is published
+    uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+
+    bool is_scanning() const { return m_scan_worker.is_busy(); }
+
+    /// number of files found so far (unfiltered)
+    size_t file_count() const;
+
+    std::string const& directory() const { return m_directory; }
+
+private:
+    struct cached_metadata
+    {
+        uint64_t size_bytes = 0;
+        int64_t modification_time = 0;
+        int64_t face_count = -1;
+    };
+
+    /// rebuilds the view on the view worker
+    void request_view();
+
+    /// appends entries if the scan is still current, returns false otherwise
+    bool append_entries(uint64_t generation, file_list& entries, std::vector<int64_t> const& modification_times);
+
+private:
+    std::string m_directory; // ui thread only
+
+    mutable std::mutex m_mutex;
+    uint64_t m_scan_generation = 0;
+    file_list m_entries;
+    std::vector<int64_t> m_modification_times; // parallel to m_entries
+    file_view_settings m_view_settings;
+    std::shared_ptr<file_list const> m_view = std::make_shared<file_list const>();
+    std::unordered_map<std::string, cached_metadata> m_metadata_cache; // key: full path
+
+    std::atomic<uint64_t> m_version = 0;
+
+    /// declared last: join the worker threads before the members above are destroyed
+    BackgroundWorker m_view_worker;
+    BackgroundWorker m_scan_worker;
+};
+}
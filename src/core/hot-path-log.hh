@@ -0,0 +1,38 @@
+#pragma once
+
+#include <rich-log/log.hh>
+
+#include <ctracer/trace.hh>
+
+//* logging and tracing for sites that run per plane or per marching step
+// even when filtered at runtime, LOGD evaluates its verbosity check and TRACE records a scope on every call
+// MK_HOT_PATH_LEVEL is the compile-time maximum for these sites, everything above it is removed completely:
+//   0 = off (release default), 1 = trace scopes, 2 = + debug logs, 3 = + trace logs (debug default)
+// the value is set by the MK_HOT_PATH_LOG_LEVEL cmake option
+// NOTE: the arguments of removed sites are not evaluated, they must not have side effects
+
+#ifndef MK_HOT_PATH_LEVEL
+#define MK_HOT_PATH_LEVEL 0
+#endif
+
+#if MK_HOT_PATH_LEVEL >= 1
+#define MK_HOT_TRACE(name) TRACE(name)
+#define MK_HOT_TRACE_BEGIN(name) TRACE_BEGIN(name)
+#define MK_HOT_TRACE_END() TRACE_END()
+#else
+#define MK_HOT_TRACE(name) (void)0
+#define MK_HOT_TRACE_BEGIN(name) (void)0
+#define MK_HOT_TRACE_END() (void)0
+#endif
+
+#if MK_HOT_PATH_LEVEL >= 2
+#define MK_HOT_LOG_DEBUG(...) LOGD(Default, Debug, __VA_ARGS__)
+#else
+#define MK_HOT_LOG_DEBUG(...) (void)0
+#endif
+
+#if MK_HOT_PATH_LEVEL >= 3
+#define MK_HOT_LOG_TRACE(...) LOGD(Default, Trace, __VA_ARGS__)
+#else
+#define MK_HOT_LOG_TRACE(...) (void)0
+#endif
@@ -1,14 +1,22 @@
 #include "kernel-app.hh"
 
 // system
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <cstdio>
 #include <filesystem>
 #include <string>
+#include <type_traits>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 // external
 
 #include <clean-core/format.hh>
-#include <clean-core/sort.hh>
 #include <clean-core/string_view.hh>
 
 #include <imgui/imgui.h>
@@ -19,7 +27,6 @@
 
 #include <rich-log/log.hh>
 
-#include <polymesh/algorithms/deduplicate.hh>
 #include <polymesh/algorithms/normalize.hh>
 #include <polymesh/formats.hh>
 #include <polymesh/formats/stl.hh>
@@ -48,8 +55,121 @@
 #endif
 
 // internal
+#include <core/certificate.hh>
+#include <core/cut-log.hh>
 #include <core/kernel-plane-cut.hh>
+#include <core/kernel-planes.hh>
+#include <core/kernel-sampler.hh>
 #include <core/lp-feasibility.hh>
+#include <core/metrics.hh>
+#include <core/option-overrides.hh>
+#include <core/stats-writer.hh>
+#include <core/vertex-weld.hh>
+
+namespace
+{
+struct bench_phase
+{
+    cc::string name;
+    double min_ms = 0.0;
+    double median_ms = 0.0;
+    double p95_ms = 0.0;
+};
+
+template <class I>
+void introspect(I&& i, bench_phase& p)
+{
+    i(p.name, "name");
+    i(p.min_ms, "min_ms");
+    i(p.median_ms, "median_ms");
+    i(p.p95_ms, "p95_ms");
+}
+
+struct bench_option_set
+{
+    cc::string overrides;
+    mk::kernel_options options;
+    int runs = 0;
+    int lp_early_out_runs = 0;
+    int empty_kernel_runs = 0;
+    cc::vector<bench_phase> phases;
+};
+
+template <class I>
+void introspect(I&& i, bench_option_set& s)
+{
+    i(s.overrides, "overrides");
+    i(s.options, "options");
+    i(s.runs, "runs");
+    i(s.lp_early_out_runs, "lp_early_out_runs");
+    i(s.empty_kernel_runs, "empty_kernel_runs");
+    i(s.phases, "phases");
+}
+
+struct batch_stats_row
+{
+    cc::string file;
+    double load_ms = 0.0;
+    double compute_ms = 0.0;
+    bool has_kernel = false;
+    bool trace_written = false;
+    bool certificate_reject = false; // rejected by a stored certificate, stats are not computed
+    mk::load_stats load;
+    mk::benchmark_data stats;
+    mk::kernel_options options;
+};
+
+template <class I>
+void introspect(I&& i, batch_stats_row& r)
+{
+    i(r.file, "file");
+    i(r.load_ms, "load_ms");
+    i(r.compute_ms, "compute_ms");
+    i(r.has_kernel, "has_kernel");
+    i(r.trace_written, "trace_written");
+    i(r.certificate_reject, "certificate_reject");
+    introspect(i, r.load);
+    introspect(i, r.stats);
+    introspect(i, r.options);
+}
+
+double percentile(cc::vector<double>& values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    auto const idx = std::min(values.size() - 1, size_t(p * double(values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + idx, values.end());
+    return values[idx];
+}
+
+/// the options of one input: --min-kernel-volume is given in input units, the clipper measures in quantized coordinates
+/// (normalized = (input - center) / scale, quantized = normalized * upscale)
+mk::kernel_options options_for_input(mk::kernel_options options, double min_kernel_volume, pm::normalize_result<double> const& normalize_result, double upscale_factor)
+{
+    if (min_kernel_volume > 0)
+    {
+        auto const s = upscale_factor / normalize_result.scale;
+        options.min_kernel_volume = min_kernel_volume * s * s * s;
+    }
+    return options;
+}
+
+/// restricts the process to the given cpus, threads spawned afterwards (e.g. the parallel exact LP) inherit the mask
+/// returns false if pinning is not supported or failed
+bool pin_to_cpus(std::vector<int> const& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto const cpu : cpus)
+        CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+}
 
 namespace mk
 {
@@ -80,6 +200,8 @@ void KernelApp::init_renderable_set()
     m_renderable_set.get_or_add_renderable_group("kernel_vertices");
     m_renderable_set.get_or_add_renderable_group("kernel_edges");
     m_renderable_set.get_or_add_renderable_group("kernel_faces");
+
+    m_renderable_set.get_or_add_renderable_group("input_heat_map").is_enabled = false;
 }
 
 
@@ -95,7 +217,11 @@ void KernelApp::run_interactive()
     gv::interactive(
         [&]()
         {
+            poll_directory_index();
+            poll_worker_results();
+
             handle_imgui();
+            update_renderables();
 
             m_fileDialog.Display();
 
@@ -103,11 +229,12 @@ void KernelApp::run_interactive()
             {
                 std::cout << "Selected folder " << m_fileDialog.GetSelected().string() << std::endl;
                 m_input_directory = m_fileDialog.GetSelected().string();
-                fetch_obj_files();
-                cc::sort(m_obj_files, [](std::string a, std::string b) { return a < b; });
                 m_fileDialog.ClearSelected();
-                m_selected_file = m_obj_files[0].c_str();
-                update_input_mesh();
+                m_mesh_cache.clear();
+                m_selected_item = 0;
+                m_selected_file.clear();
+                m_select_first_file = true;
+                m_directory_index.scan(m_input_directory);
             }
 
             auto v = gv::view();
@@ -146,11 +273,29 @@ void KernelApp::run_cli(int argc, char** args)
     bool disable_kdop = false;
     bool only_check_exact_feasibility = false;
 
+    int bench_runs = 0;
+    int bench_warmup_runs = 1;
+    std::vector<int> pin_cpus;
+    std::vector<std::string> bench_option_sets;
+
+    int sample_count = 0;
+    uint64_t sample_seed = 0;
+    std::string sampler = "tets";
+
+    std::string auto_rules_path;
+    std::string calibration_corpus;
+    int calibration_runs = 3;
+
+    double status_interval = 0.0;
+    std::string status_path;
+
+    batch_settings batch;
+
     std::string input_path;
     std::string output_path;
     std::string output_extension = "obj";
 
-    app.add_option("-i, --input", input_path, "path to input mesh");
+    app.add_option("-i, --input", input_path, "path to input mesh (directory in batch mode)");
     app.add_option("-o, --output", output_path, "path to output mesh");
     app.add_option("-e, --extension", output_extension, "file extension of the output file. Possible values: stl/obj");
 
@@ -165,6 +310,43 @@ void KernelApp::run_cli(int argc, char** args)
     app.add_flag("--disable-kdop", disable_kdop, "disable the kdop culling");
     app.add_option("-k, --kdop-k", m_options.kdop_k, "sets the kdop k (default = 3, aabb)");
     app.add_flag("--triangulate", m_options.triangulate, "triangulate the output mesh");
+    app.add_option("--min-kernel-volume", m_min_kernel_volume,
+                   "kernels with a smaller volume (in input units) are reported as too small, clipping stops as soon as the volume drops below");
+    app.add_flag("--output-planes", m_output_planes,
+                 "writes the distinct bounding planes of the kernel (exact, with their input faces) to <output>/<name>.mkplanes instead of a mesh");
+
+    app.add_flag("--batch", batch_mode, "processes all obj files in the input directory");
+    app.add_option("--batch-stats", batch.stats_path, "path (without extension) of the aggregated stats files (default = <output>/batch_stats)");
+    app.add_option("--trace-sample-rate", batch.trace_sample_rate, "batch mode: writes a trace for every n-th mesh, 0 = none (default = 100)");
+    app.add_option("--trace-threshold-ms", batch.trace_threshold_ms,
+                   "batch mode: additionally writes a trace for every mesh slower than this, 0 = disabled (default = 1000)");
+
+    app.add_option("--bench", bench_runs, "computes the kernel N times in-process and reports min/median/p95 per phase (no output mesh is written)");
+    app.add_option("--bench-warmup", bench_warmup_runs, "number of unmeasured warm-up runs per option set (default = 1)");
+    app.add_option("--bench-options", bench_option_sets,
+                   "option set to compare, e.g. \"use_bb_culling=0,kdop_k=8\". Can be repeated, each set overrides the command line options");
+    app.add_option("--pin-cpu", pin_cpus, "pins the process to the given cpus, e.g. 2,3 (linux only)")->delimiter(',');
+
+    app.add_flag("--record-cuts", m_options.record_cut_log,
+                 "writes the planes and decisions of the cutting phase to <output>/traces/<name>.mkcuts (input of mesh-kernel-replay)");
+
+    app.add_option("--status-interval", status_interval, "logs a status line (phase, planes, exact LP, batch progress) every N seconds (default = 0, off)");
+    app.add_option("--status-file", status_path, "rewrites this json file with the current progress every status interval (default = every second)");
+
+    app.add_option("--metrics-file", batch.metrics_path, "batch mode: rewrites this file with OpenMetrics text (latency histograms, counts, cull rate)");
+    app.add_option("--metrics-port", batch.metrics_port, "batch mode: serves the metrics on http://127.0.0.1:<port>/metrics (linux only)");
+
+    app.add_option("--certificate-dir", batch.certificate_dir,
+                   "stores a certificate for every empty kernel and checks it before recomputing the same file (also in batch mode)");
+
+    app.add_option("--samples", sample_count, "writes N uniform random points inside the kernel to <output>/<name>_samples.xyz");
+    app.add_option("--sampler", sampler, "sampler for --samples: tets (exact, default) or hit-and-run (random walk on the cutting planes)");
+    app.add_option("--sample-seed", sample_seed, "seed of --samples (default = 0)");
+
+    app.add_flag("--auto", m_auto_options, "chooses the options per input from its statistics (face count, concave edges, distinct normals)");
+    app.add_option("--auto-rules", auto_rules_path, "rule table of --auto, e.g. written by --calibrate (default = built-in rules)");
+    app.add_option("--calibrate", calibration_corpus, "times candidate options on all obj files of this directory and writes <output>/auto_rules.mkrules");
+    app.add_option("--calibrate-runs", calibration_runs, "timed runs per mesh and candidate of --calibrate, the median is used (default = 3)");
 
     try
     {
@@ -188,6 +370,18 @@ void KernelApp::run_cli(int argc, char** args)
         exit(0);
     }
 
+    if (m_output_planes)
+    {
+        // triangles share the plane of their polygon
+        m_options.triangulate = false;
+        if (show_result || sample_count > 0)
+        {
+            LOGD(Default, Warning, "--output-planes computes no result mesh, --show-result and --samples are ignored");
+            show_result = false;
+            sample_count = 0;
+        }
+    }
+
     output_path = std::filesystem::path(output_path).string();
 
     util::make_directories(output_path);
@@ -207,9 +401,36 @@ void KernelApp::run_cli(int argc, char** args)
     }
 
 
+    if (!batch.certificate_dir.empty())
+        util::make_directories(batch.certificate_dir);
+
+    // always running: SIGUSR1 dumps the progress even without a status line or file
+    m_plane_cut.set_run_progress(&m_run_progress);
+    ProgressReporter reporter(m_run_progress, status_interval, status_path);
+
+    if (!calibration_corpus.empty())
+    {
+        run_calibration(calibration_corpus, output_path + "/auto_rules.mkrules", calibration_runs);
+        return;
+    }
+
+    if (m_auto_options)
+    {
+        if (auto_rules_path.empty())
+            m_auto_rules = default_auto_rules();
+        else if (!load_auto_rules(auto_rules_path, m_auto_rules))
+        {
+            LOGD(Default, Error, "could not read the auto rules %s", auto_rules_path);
+            exit(0);
+        }
+    }
+
     if (batch_mode)
     {
-        run_batch(input_path, output_path, traces_path);
+        if (batch.stats_path.empty())
+            batch.stats_path = output_path + "/batch_stats";
+
+        run_batch(input_path, output_path, traces_path, batch);
         return;
     }
 
@@ -219,6 +440,7 @@ void KernelApp::run_cli(int argc, char** args)
 
     LOGD(Default, Info, "Processing %s", input_path);
 
+    m_run_progress.phase.store(run_phase::loading, std::memory_order_relaxed);
     if (!load_mesh(input_path, true))
         exit(0);
 
@@ -238,20 +460,50 @@ void KernelApp::run_cli(int argc, char** args)
 
     auto const file_name = std::filesystem::path(input_path).stem().string();
 
+    if (m_auto_options)
+        apply_auto_options(kernel_options(m_options), traces_path + file_name + "_auto_options.json");
+
+    if (bench_runs > 0)
+    {
+        if (!pin_cpus.empty() && !pin_to_cpus(pin_cpus))
+            LOGD(Default, Warning, "could not pin the process to the requested cpus");
+
+        run_bench(traces_path + file_name + "_bench.json", bench_runs, bench_warmup_runs, bench_option_sets);
+        return;
+    }
+
+    auto const certificate_path = batch.certificate_dir.empty() ? std::string() : batch.certificate_dir + "/" + file_name + ".mkcert";
+    if (!certificate_path.empty() && check_certificate(certificate_path))
+    {
+        LOGD(Default, Info, "kernel is empty, the stored certificate %s still holds", certificate_path);
+        return;
+    }
+
     {
         ct::scope s;
         compute_mesh_kernel();
         ct::write_speedscope_json(s.trace(), traces_path + file_name + ".json");
         babel::file::write(traces_path + file_name + "_metadata.json", babel::json::to_string(m_plane_cut.stats()));
-        babel::file::write(traces_path + file_name + "_options.json", babel::json::to_string(m_options));
+        babel::file::write(traces_path + file_name + "_options.json", babel::json::to_string(input_options()));
     }
 
+    if (m_options.record_cut_log && !m_plane_cut.recorded_cut_log().planes.empty() && !save_cut_log(traces_path + file_name + ".mkcuts", m_plane_cut.recorded_cut_log()))
+        LOGD(Default, Warning, "could not write the cut log of %s", file_name);
+
+    if (!certificate_path.empty())
+        update_certificate(certificate_path);
+
     LOGD(Default, Info, "done!");
 
-    if (!m_result_empty)
+    if (!m_result_empty && m_output_planes)
+        save_kernel_planes(output_path + "/" + file_name + ".mkplanes");
+    else if (!m_result_empty)
     {
         auto const full_path = output_path + "/" + file_name + "." + output_extension;
         save_kernel(full_path);
+
+        if (sample_count > 0)
+            save_kernel_samples(output_path + "/" + file_name + "_samples.xyz", sample_count, sample_seed, sampler == "hit-and-run");
     }
 
     if (show_result || show_input)
@@ -262,9 +514,9 @@ void KernelApp::run_cli(int argc, char** args)
 
         if (show_result)
         {
-            gv::view(m_current_position, gv::maybe_empty, gv::no_shading, gv::no_shadow);
-            gv::view(gv::points(m_current_position).point_size_px(10));
-            gv::view(gv::lines(m_current_position).line_width_px(0.5));
+            gv::view(*m_result_position, gv::maybe_empty, gv::no_shading, gv::no_shadow);
+            gv::view(gv::points(*m_result_position).point_size_px(10));
+            gv::view(gv::lines(*m_result_position).line_width_px(0.5));
         }
         if (show_input)
             gv::view(gv::lines(m_input_position).line_width_px(0.5));
@@ -272,11 +524,46 @@ void KernelApp::run_cli(int argc, char** args)
 }
 
 
-void KernelApp::run_batch(std::string const& input_path, std::string const& output_path, std::string const& traces_path)
+void KernelApp::run_batch(std::string const& input_path, std::string const& output_path, std::string const& traces_path, batch_settings const& settings)
 {
+    using clock = std::chrono::steady_clock;
+
     int total_files = std::distance(std::filesystem::directory_iterator(input_path), std::filesystem::directory_iterator{});
     LOGD(Default, Info, "Total number of files in the directory: %d", total_files);
 
+    auto obj_files = 0;
+    for (auto const& entry : std::filesystem::directory_iterator(input_path))
+        obj_files += entry.is_regular_file() && entry.path().extension() == ".obj";
+    m_run_progress.batch_done.store(0, std::memory_order_relaxed);
+    m_run_progress.batch_total.store(obj_files, std::memory_order_relaxed);
+
+    // one worker: the meshes are processed in this thread
+    Metrics metrics(1);
+    auto& worker = metrics.worker(0);
+    metrics.set_queue_depth(obj_files);
+    std::unique_ptr<MetricsServer> metrics_server;
+    if (settings.metrics_port > 0)
+        metrics_server = std::make_unique<MetricsServer>(metrics, settings.metrics_port);
+
+    auto last_metrics_write = clock::now();
+    auto const mesh_done = [&]
+    {
+        m_run_progress.batch_done.fetch_add(1, std::memory_order_relaxed);
+        metrics.set_queue_depth(obj_files - m_run_progress.batch_done.load(std::memory_order_relaxed));
+
+        if (!settings.metrics_path.empty() && clock::now() - last_metrics_write > std::chrono::seconds(1))
+        {
+            metrics.write_file(settings.metrics_path);
+            last_metrics_write = clock::now();
+        }
+    };
+
+    // one row per mesh instead of a metadata json per mesh
+    StatsWriter stats_writer(settings.stats_path);
+
+    // --auto changes m_options per mesh, the choice is recorded in the options of the stats row
+    auto const base_options = m_options;
+
     int file_count = 0;
     for (auto const& entry : std::filesystem::directory_iterator(input_path))
     {
@@ -288,26 +575,270 @@ void KernelApp::run_batch(std::string const& input_path, std::string const& outp
 
             LOGD(Default, Info, "Processing %s/%s file: %s", file_count, total_files, input_file);
 
+            batch_stats_row row;
+            row.file = entry.path().filename().string().c_str();
+
+            auto const t_load = clock::now();
+            m_run_progress.phase.store(run_phase::loading, std::memory_order_relaxed);
             if (!load_mesh(input_file, true))
+            {
+                worker.add_load_failure(std::chrono::duration<double>(clock::now() - t_load).count());
+                mesh_done();
                 continue;
+            }
+            row.load_ms = std::chrono::duration<double, std::milli>(clock::now() - t_load).count();
+            row.load = m_load_stats;
 
-            ct::scope s;
+            if (m_auto_options)
+                apply_auto_options(base_options, {});
+
+            auto const file_name = entry.path().stem().string();
+            auto const certificate_path = settings.certificate_dir.empty() ? std::string() : settings.certificate_dir + "/" + file_name + ".mkcert";
+
+            auto const t_certificate = clock::now();
+            if (!certificate_path.empty() && check_certificate(certificate_path))
+            {
+                row.compute_ms = std::chrono::duration<double, std::milli>(clock::now() - t_certificate).count();
+                row.certificate_reject = true;
+                row.options = input_options();
+                row.stats.input_faces = int(m_input_mesh.faces().size());
+                stats_writer.write(row);
+                worker.add_certificate_reject((row.load_ms + row.compute_ms) / 1000.0);
+                mesh_done();
+                continue;
+            }
 
-            auto const filen_ame = entry.path().stem().string();
+            ct::scope s;
 
+            auto const t_compute = clock::now();
             compute_mesh_kernel();
-            ct::write_speedscope_json(s.trace(), traces_path + filen_ame + ".json");
+            row.compute_ms = std::chrono::duration<double, std::milli>(clock::now() - t_compute).count();
+
+            if (!certificate_path.empty())
+                update_certificate(certificate_path);
+
+            if (m_options.record_cut_log && !m_plane_cut.recorded_cut_log().planes.empty() && !save_cut_log(traces_path + file_name + ".mkcuts", m_plane_cut.recorded_cut_log()))
+                LOGD(Default, Warning, "could not write the cut log of %s", file_name);
+
+            // traces are only kept for a sampled subset and for outliers
+            auto const sampled = settings.trace_sample_rate > 0 && (file_count - 1) % settings.trace_sample_rate == 0;
+            auto const slow = settings.trace_threshold_ms > 0 && row.compute_ms > settings.trace_threshold_ms;
+            if (sampled || slow)
+            {
+                ct::write_speedscope_json(s.trace(), traces_path + file_name + ".json");
+                row.trace_written = true;
+            }
 
-            auto const bm_data = benchmark_data{m_input_mesh.faces().size(), m_current_mesh.faces().size()};
-            babel::file::write(traces_path + filen_ame + "_metadata.json", babel::json::to_string(bm_data));
+            row.has_kernel = !m_result_empty;
+            row.stats = m_plane_cut.stats();
+            row.options = input_options();
+            stats_writer.write(row);
 
-            if (!m_result_empty)
+            if (!m_result_empty && m_output_planes)
+                save_kernel_planes(output_path + "/" + file_name + ".mkplanes");
+            else if (!m_result_empty)
             {
                 LOGD(Default, Info, "Writing output to %s", output_file);
-                pm::save(output_file, m_current_position);
+                pm::save(output_file, *m_result_position);
             }
+
+            worker.add_mesh(row.stats, row.load_ms / 1000.0, row.has_kernel);
+            mesh_done();
         }
     }
+
+    stats_writer.close();
+    LOGD(Default, Info, "Wrote stats of %s meshes to %s.csv/.mkstats", file_count, settings.stats_path);
+
+    if (!settings.metrics_path.empty() && !metrics.write_file(settings.metrics_path))
+        LOGD(Default, Warning, "could not write the metrics %s", settings.metrics_path);
+
+    m_options = base_options;
+}
+
+void KernelApp::apply_auto_options(kernel_options const& base_options, std::string const& record_path)
+{
+    auto_options_record record;
+    record.statistics = compute_input_statistics(m_input_int_position);
+
+    m_options = base_options;
+    record.applied_rules = apply_auto_rules(m_auto_rules, record.statistics, m_options);
+    record.options = m_options;
+
+    LOGD(Default, Info, "[auto] %s faces, %s concave edges, %s distinct normals: %s rules applied", record.statistics.faces,
+         record.statistics.concave_edge_fraction, record.statistics.distinct_normals, record.applied_rules.size());
+    for (auto const& name : record.applied_rules)
+        LOGD(Default, Info, "[auto]   %s", name);
+
+    if (!record_path.empty())
+        babel::file::write(record_path, babel::json::to_string(record));
+}
+
+void KernelApp::run_calibration(std::string const& corpus_path, std::string const& rules_path, int runs)
+{
+    using clock = std::chrono::steady_clock;
+
+    if (!std::filesystem::is_directory(corpus_path))
+    {
+        LOGD(Default, Error, "%s must be a valid directory", corpus_path);
+        return;
+    }
+
+    runs = std::max(1, runs);
+    auto const base_options = m_options;
+    auto const candidates = AutoCalibration::candidate_overrides();
+
+    AutoCalibration calibration;
+    int mesh_count = 0;
+    for (auto const& entry : std::filesystem::directory_iterator(corpus_path))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".obj")
+            continue;
+
+        if (!load_mesh(entry.path().string(), true))
+            continue;
+
+        auto const stats = compute_input_statistics(m_input_int_position);
+
+        // the per-run logging would dominate small meshes
+        auto const verbosity = Log::Default::domain.min_verbosity;
+        Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+        cc::vector<double> candidate_ms;
+        for (auto const& overrides : candidates)
+        {
+            m_options = base_options;
+            std::string error;
+            if (!apply_overrides(std::string_view(overrides.data(), overrides.size()), m_options, &error))
+            {
+                LOGD(Default, Error, "invalid calibration candidate '%s': %s", overrides, error);
+                candidate_ms.push_back(DBL_MAX);
+                continue;
+            }
+
+            cc::vector<double> ms;
+            for (auto r = 0; r < runs; ++r)
+            {
+                ct::scope s; // do not accumulate traces over the runs
+                auto const t0 = clock::now();
+                compute_mesh_kernel();
+                ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - t0).count());
+            }
+            std::sort(ms.begin(), ms.end());
+            candidate_ms.push_back(ms[ms.size() / 2]);
+        }
+
+        Log::Default::domain.min_verbosity = verbosity;
+
+        calibration.add(stats, candidate_ms);
+        mesh_count++;
+        LOGD(Default, Info, "[calibrate] %s: %s faces, base options %s ms", entry.path().filename().string(), stats.faces, candidate_ms[0]);
+    }
+
+    m_options = base_options;
+
+    auto const rules = calibration.derive_rules();
+    if (!save_auto_rules(rules_path, rules))
+    {
+        LOGD(Default, Error, "could not write %s", rules_path);
+        return;
+    }
+    LOGD(Default, Info, "[calibrate] %s meshes, wrote %s rules to %s", mesh_count, rules.size(), rules_path);
+}
+
+void KernelApp::run_bench(std::string const& report_path, int runs, int warmup_runs, std::vector<std::string> const& option_sets)
+{
+    using clock = std::chrono::steady_clock;
+
+    // the per-run logging would dominate the small phases
+    auto const verbosity = Log::Default::domain.min_verbosity;
+    Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+
+    auto const base_options = m_options;
+    auto sets = option_sets;
+    if (sets.empty())
+        sets.push_back("");
+
+    struct phase_samples
+    {
+        char const* name;
+        double benchmark_data::*seconds; // nullptr for the values computed in this function
+        cc::vector<double> ms;
+    };
+
+    cc::vector<bench_option_set> report;
+    for (auto const& overrides : sets)
+    {
+        m_options = base_options;
+        std::string error;
+        if (!apply_overrides(overrides, m_options, &error))
+        {
+            LOGD(Default, Error, "invalid option set '%s': %s", overrides, error);
+            continue;
+        }
+
+        cc::vector<phase_samples> phases = {
+            {"input_planes", &benchmark_data::time_input_planes_seconds, {}},
+            {"edge_state", &benchmark_data::time_edge_state_seconds, {}},
+            {"cutting_planes", &benchmark_data::time_cutting_planes_seconds, {}},
+            {"supporting_structure", &benchmark_data::time_supporting_structure_seconds, {}},
+            {"cutting", &benchmark_data::time_cutting_seconds, {}},
+            {"finalize", &benchmark_data::time_finalize_seconds, {}},
+            {"result_conversion", nullptr, {}},
+            {"total", nullptr, {}},
+        };
+
+        auto& set = report.emplace_back();
+        set.overrides = overrides.c_str();
+        set.options = m_options;
+
+        for (auto r = -tg::max(0, warmup_runs); r < runs; ++r)
+        {
+            ct::scope s; // do not accumulate traces over the runs
+
+            auto const t0 = clock::now();
+            compute_mesh_kernel();
+            auto const total_ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+
+            if (r < 0)
+                continue;
+
+            auto const& stats = m_plane_cut.stats();
+            for (auto& p : phases)
+                if (p.seconds)
+                    p.ms.push_back(stats.*p.seconds * 1000.0);
+
+            phases[phases.size() - 2].ms.push_back(tg::max(0.0, total_ms - stats.time_total_seconds * 1000.0));
+            phases.back().ms.push_back(total_ms);
+
+            set.runs++;
+            if (stats.lp_early_out)
+                set.lp_early_out_runs++;
+            if (m_result_empty)
+                set.empty_kernel_runs++;
+        }
+
+        Log::Default::domain.min_verbosity = verbosity;
+        LOGD(Default, Info, "[bench] options '%s': %s runs, lp early out in %s runs, empty kernel in %s runs", overrides, set.runs,
+             set.lp_early_out_runs, set.empty_kernel_runs);
+
+        for (auto& p : phases)
+        {
+            auto& phase = set.phases.emplace_back();
+            phase.name = p.name;
+            phase.min_ms = percentile(p.ms, 0.0);
+            phase.median_ms = percentile(p.ms, 0.5);
+            phase.p95_ms = percentile(p.ms, 0.95);
+            LOGD(Default, Info, "[bench]   %s: min %s ms, median %s ms, p95 %s ms", phase.name, phase.min_ms, phase.median_ms, phase.p95_ms);
+        }
+        Log::Default::domain.min_verbosity = rlog::verbosity::Warning;
+    }
+
+    Log::Default::domain.min_verbosity = verbosity;
+    m_options = base_options;
+
+    babel::file::write(report_path, babel::json::to_string(report));
+    LOGD(Default, Info, "[bench] wrote report to %s", report_path);
 }
 
 void KernelApp::trace_full_computation()
@@ -319,12 +850,23 @@ void KernelApp::trace_full_computation()
 
 void KernelApp::save_kernel(cc::string_view filepath)
 {
-    m_current_mesh.compactify();
+    // a shown snapshot is shared with the cache and not compact: copied once, only when saving
+    if (m_result_snapshot && !m_result_snapshot->input_kernel)
+    {
+        m_current_mesh.copy_from(m_result_snapshot->mesh);
+        m_current_position = m_result_snapshot->position.copy_to(m_current_mesh);
+        m_result_position = &m_current_position;
+        m_result_snapshot = nullptr;
+    }
+
+    // the input (convex case) is already compact
+    if (m_result_position == &m_current_position)
+        m_current_mesh.compactify();
     auto path = std::filesystem::path(filepath.begin(), filepath.end());
     LOGD(Default, Info, "Writing output to %s", std::filesystem::absolute(path).string());
 
     auto const center = tg::dpos3(m_normalize_result.center_x, m_normalize_result.center_y, m_normalize_result.center_z);
-    auto tmp_pos = m_current_position.map([&](auto const& p) { return m_normalize_result.scale * p + center; });
+    auto tmp_pos = m_result_position->map([&](auto const& p) { return m_normalize_result.scale * p + center; });
     if (filepath.ends_with("stl"))
     {
         auto const pos = tmp_pos.map([](auto const& p) { return tg::pos3(p); });
@@ -340,32 +882,160 @@ void KernelApp::save_kernel(cc::string_view filepath)
     }
 }
 
+void KernelApp::save_kernel_planes(std::string const& filepath)
+{
+    auto const planes = m_plane_cut.kernel_planes();
+    LOGD(Default, Info, "Writing %s kernel planes to %s", planes.size(), std::filesystem::absolute(filepath).string());
+
+    if (!mk::save_kernel_planes(filepath, planes, int(m_input_mesh.faces().size()), m_upscale_factor))
+        LOGD(Default, Error, "could not write %s", filepath);
+}
+
+void KernelApp::save_kernel_samples(std::string const& filepath, int count, uint64_t seed, bool use_hit_and_run)
+{
+    std::vector<tg::dpos3> samples;
+
+    // the cutting planes only exist for non-convex inputs
+    if (use_hit_and_run && !m_plane_cut.input_is_convex())
+    {
+        HitAndRunSampler sampler;
+        if (sampler.build(m_plane_cut.cutting_planes()))
+            samples = sampler.sample(count, seed);
+        for (auto& p : samples)
+            p = cut_coord_to_normalized_coord(p);
+    }
+    else
+    {
+        KernelSampler sampler;
+        if (sampler.build(*m_result_position))
+            samples = sampler.sample(count, seed);
+    }
+
+    if (samples.empty())
+    {
+        LOGD(Default, Warning, "could not sample the kernel (no volume)");
+        return;
+    }
+
+    auto const center = tg::dpos3(m_normalize_result.center_x, m_normalize_result.center_y, m_normalize_result.center_z);
+    auto* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+    {
+        LOGD(Default, Error, "could not write %s", filepath);
+        return;
+    }
+    for (auto const& p : samples)
+    {
+        auto const q = m_normalize_result.scale * p + center;
+        std::fprintf(file, "%.17g %.17g %.17g\n", q.x, q.y, q.z);
+    }
+    std::fclose(file);
+
+    LOGD(Default, Info, "Wrote %s samples to %s", samples.size(), filepath);
+}
+
+bool KernelApp::check_certificate(std::string const& path)
+{
+    std::vector<int> faces;
+    if (!load_certificate(path, faces) || !certificate_holds(m_input_int_position, faces))
+        return false;
+
+    m_result_empty = true;
+    m_current_mesh.clear();
+    m_result_position = &m_current_position;
+    return true;
+}
+
+void KernelApp::update_certificate(std::string const& path)
+{
+    auto const& certificate = m_plane_cut.infeasibility_certificate();
+    if (!m_result_empty || certificate.empty())
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return;
+    }
+
+    std::vector<int> faces;
+    for (auto const f : certificate)
+        faces.push_back(int(f.idx.value));
+
+    if (!save_certificate(path, faces, int(m_input_mesh.faces().size())))
+        LOGD(Default, Warning, "could not write the certificate %s", path);
+}
+
 //* sets m_input_mesh and m_input_position
 
 bool KernelApp::load_mesh(cc::string_view const& path, bool normalize)
+{
+    prepared_mesh input;
+    if (!prepare_mesh(path, normalize, input))
+        return false;
+
+    set_input_mesh(input);
+    return true;
+}
+
+bool KernelApp::prepare_mesh(cc::string_view const& path, bool normalize, prepared_mesh& result)
 {
     LOGD(Default, Info, "Loading mesh %s", path);
 
-    m_input_mesh.clear();
-    m_input_position.clear();
-    if (!pm::load(std::string(path.data(), path.size()), m_input_mesh, m_input_position))
+    using clock = std::chrono::steady_clock;
+    auto const seconds_since = [](clock::time_point t) { return std::chrono::duration<double>(clock::now() - t).count(); };
+
+    auto& mesh = result.mesh;
+    auto& position = result.position;
+    result.stats = {};
+
+    auto t = clock::now();
+    mesh.clear();
+    position.clear();
+    if (!pm::load(std::string(path.data(), path.size()), mesh, position))
     {
         LOGD(Default, Error, "Failed to load %s", path);
         return false;
     }
-    if (m_input_position.empty())
+    if (position.empty())
     {
         LOGD(Default, Info, "input mesh %s is empty!", path);
         return false;
     }
-    if (!pm::is_closed_mesh(m_input_mesh))
+    result.stats.time_read_seconds = seconds_since(t);
+
+    // normalization and scaling only depend on the bounding box, duplicated vertices do not change them
+    t = clock::now();
+    if (normalize)
+        result.normalize_result = pm::normalize(position);
+
+    result.upscale_factor = get_scaling_factor(position);
+    for (auto const v : mesh.vertices())
+    {
+        result.int_position[v] = pos_t(position[v] * result.upscale_factor);
+        CC_ASSERT(tg::abs(result.int_position[v].x) <= (ipg::i64(1) << geometry_t::bits_position));
+        CC_ASSERT(tg::abs(result.int_position[v].y) <= (ipg::i64(1) << geometry_t::bits_position));
+        CC_ASSERT(tg::abs(result.int_position[v].z) <= (ipg::i64(1) << geometry_t::bits_position));
+    }
+    result.stats.time_quantize_seconds = seconds_since(t);
+
+    // welded on the quantized positions: vertices that became equal are merged exactly
+    if (!pm::is_closed_mesh(mesh))
     {
         LOGD(Default, Info, "input mesh %s not closed!", path);
-        if (pm::deduplicate(m_input_mesh, m_input_position) == -1)
+        t = clock::now();
+        auto const weld = weld_vertices(mesh, position, result.int_position);
+        result.stats.time_weld_seconds = seconds_since(t);
+        result.stats.welded_vertices = weld.removed_vertices;
+        result.stats.degenerate_faces = weld.degenerate_faces;
+        if (!weld.success)
+        {
+            LOGD(Default, Info, "input mesh %s is not manifold after welding!", path);
             return false;
+        }
+        LOGD(Default, Info, "welded %s vertices (%s degenerate faces) in %s ms", weld.removed_vertices, weld.degenerate_faces,
+             int(result.stats.time_weld_seconds * 1000));
     }
 
-    auto const euler = pm::euler_characteristic(m_input_mesh);
+    auto const euler = pm::euler_characteristic(mesh);
     auto const genus = (2 - euler) * 0.5;
     if (genus > 0)
     {
@@ -373,33 +1043,43 @@ bool KernelApp::load_mesh(cc::string_view const& path, bool normalize)
         return false;
     }
 
-    if (normalize)
-        m_normalize_result = pm::normalize(m_input_position);
-
-    m_upscale_factor = get_scaling_factor(m_input_position);
-    for (auto const v : m_input_mesh.vertices())
-    {
-        m_input_int_position[v] = pos_t(m_input_position[v] * m_upscale_factor);
-        CC_ASSERT(tg::abs(m_input_int_position[v].x) <= (ipg::i64(1) << geometry_t::bits_position));
-        CC_ASSERT(tg::abs(m_input_int_position[v].y) <= (ipg::i64(1) << geometry_t::bits_position));
-        CC_ASSERT(tg::abs(m_input_int_position[v].z) <= (ipg::i64(1) << geometry_t::bits_position));
-    }
-
-    m_input_mesh.compactify();
+    mesh.compactify();
 
     return true;
 }
 
+void KernelApp::set_input_mesh(prepared_mesh const& input)
+{
+    m_input_mesh.copy_from(input.mesh);
+    m_input_position.copy_from(input.position);
+    m_input_int_position.copy_from(input.int_position);
+    m_normalize_result = input.normalize_result;
+    m_upscale_factor = input.upscale_factor;
+    m_load_stats = input.stats;
+}
+
 // returns true if result non-empty
 
+kernel_options KernelApp::input_options() const { return options_for_input(m_options, m_min_kernel_volume, m_normalize_result, m_upscale_factor); }
+
+kernel_options KernelApp::input_options(prepared_mesh const& input) const
+{
+    return options_for_input(m_options, m_min_kernel_volume, input.normalize_result, input.upscale_factor);
+}
+
 void KernelApp::compute_mesh_kernel()
 {
-    m_plane_cut.compute_kernel(m_input_int_position, m_options);
+    m_plane_cut.compute_kernel(m_input_int_position, input_options());
 
     if (!m_plane_cut.has_kernel())
     {
         m_result_empty = true;
-        LOGD(Default, Info, "kernel is empty!");
+        if (m_plane_cut.stats().clip_failed)
+            LOGD(Default, Warning, "clipping failed, no kernel!");
+        else if (m_plane_cut.stats().kernel_too_small)
+            LOGD(Default, Info, "kernel is smaller than --min-kernel-volume!");
+        else
+            LOGD(Default, Info, "kernel is empty!");
         return;
     }
 
@@ -408,15 +1088,18 @@ void KernelApp::compute_mesh_kernel()
     if (m_plane_cut.input_is_convex())
     {
         LOGD(Default, Info, "Input is convex!");
-        m_current_mesh.copy_from(m_input_mesh);
-        m_current_position.copy_from(m_input_position);
+        m_result_position = &m_input_position;
+    }
+    else if (m_output_planes)
+    {
+        // the planes are read from m_plane_cut directly
+        m_current_mesh.clear();
+        m_result_position = &m_current_position;
     }
     else
     {
-        auto const& vertex_points = m_plane_cut.position_point4();
-        m_current_mesh.copy_from(m_plane_cut.mesh());
-        m_current_position = to_dpos(vertex_points.copy_to(m_current_mesh));
-        m_current_position.apply([&](tg::dpos3& p) { p = cut_coord_to_normalized_coord(p); });
+        m_plane_cut.copy_result(m_current_mesh, m_current_position, m_upscale_factor);
+        m_result_position = &m_current_position;
     }
 }
 
@@ -439,26 +1122,31 @@ double KernelApp::get_scaling_factor(pm::vertex_attribute<tg::dpos3> const& poin
     return scaling_factor;
 }
 
-pm::vertex_attribute<tg::dpos3> KernelApp::to_dpos(pm::vertex_attribute<point4_t> const& vertex_points)
+void KernelApp::poll_directory_index()
 {
-    pm::vertex_attribute<tg::dpos3> result(vertex_points.mesh());
-    for (auto vertex_handle : vertex_points.mesh().vertices())
-    {
-        result(vertex_handle) = ipg::to_dpos3(vertex_points(vertex_handle));
-    }
-    return result;
-}
+    auto const version = m_directory_index.version();
+    if (version == m_files_version)
+        return;
 
-void KernelApp::fetch_obj_files()
-{
-    m_obj_files.clear();
-    for (auto const& entry : std::filesystem::directory_iterator(m_input_directory))
-    {
-        auto const extension = entry.path().extension();
-        if (entry.is_regular_file() && (extension == ".obj" || extension == ".off" || extension == ".stl"))
+    m_files_version = version;
+    m_files = m_directory_index.view();
+
+    // the view is re-sorted while scanning, follow the selected file
+    for (size_t i = 0; i < m_files->size(); ++i)
+        if ((*m_files)[i].name == m_selected_file.c_str())
         {
-            m_obj_files.push_back(entry.path().filename().string());
+            m_selected_item = i;
+            break;
         }
+    if (m_selected_item >= m_files->size())
+        m_selected_item = 0;
+
+    if (m_select_first_file && !m_files->empty())
+    {
+        m_select_first_file = false;
+        m_selected_item = 0;
+        m_selected_file = (*m_files)[0].name.c_str();
+        update_input_mesh();
     }
 }
 
@@ -472,18 +1160,45 @@ bool KernelApp::select_mesh_window()
     }
 
     ImGui::SetNextWindowPos(ImVec2(300, 60), ImGuiCond_Once);
-    ImGui::SetNextWindowSize(ImVec2(200, 250), ImGuiCond_Once);
+    ImGui::SetNextWindowSize(ImVec2(350, 330), ImGuiCond_Once);
     ImGui::Begin("Select Mesh");
 
+    if (ImGui::InputText("filter", &m_file_view_settings.filter))
+        m_directory_index.set_view_settings(m_file_view_settings);
+
+    char const* sort_options[] = {"name", "size", "faces"};
+    auto sort_current = int(m_file_view_settings.sort);
+    if (ImGui::Combo("sort by", &sort_current, sort_options, IM_ARRAYSIZE(sort_options)))
+    {
+        m_file_view_settings.sort = file_sort(sort_current);
+        m_directory_index.set_view_settings(m_file_view_settings);
+    }
+    ImGui::SameLine();
+    if (ImGui::Checkbox("desc", &m_file_view_settings.descending))
+        m_directory_index.set_view_settings(m_file_view_settings);
+
+    ImGui::Text("%d of %d files%s", int(m_files->size()), int(m_directory_index.file_count()), m_directory_index.is_scanning() ? " (scanning...)" : "");
+
     if (ImGui::BeginListBox("##objfiles", ImVec2(-1, 200)))
     {
-        for (size_t i = 0; i < m_obj_files.size(); ++i)
+        // only the visible rows are submitted
+        ImGuiListClipper clipper;
+        clipper.Begin(int(m_files->size()));
+        while (clipper.Step())
         {
-            bool is_selected = (m_selected_item == i);
-            if (ImGui::Selectable(m_obj_files[i].c_str(), is_selected))
+            for (auto i = size_t(clipper.DisplayStart); i < size_t(clipper.DisplayEnd); ++i)
             {
-                m_selected_item = i;
-                m_selected_file = m_obj_files[i].c_str(); // Update the selected file
+                auto const& entry = (*m_files)[i];
+                auto const label = entry.face_count >= 0
+                                       ? cc::format("%s  (%s faces, %s KB)###%s", entry.name, entry.face_count, entry.size_bytes / 1024, i)
+                                       : cc::format("%s  (%s KB)###%s", entry.name, entry.size_bytes / 1024, i);
+
+                bool is_selected = (m_selected_item == i);
+                if (ImGui::Selectable(label.c_str(), is_selected))
+                {
+                    m_selected_item = i;
+                    m_selected_file = entry.name.c_str(); // Update the selected file
+                }
             }
         }
         ImGui::EndListBox();
@@ -515,15 +1230,333 @@ void KernelApp::update_input_mesh()
         LOGD(Default, Error, "File %s does not exist", input_file_path);
         return;
     }
-    load_mesh(input_file_path);
-    add_renderable_to_groups("input", m_input_position);
+
+    auto const path = std::string(input_file_path.c_str());
+    if (!show_cached(path, m_selected_file))
+        start_loading(input_file_path, m_selected_file);
+
+    start_prefetch();
+}
+
+
+uint64_t KernelApp::next_task_generation()
+{
+    std::lock_guard lock(m_worker_result_mutex);
+    m_load_finished = false;
+    m_loaded_input = nullptr;
+    m_kernel_snapshot = nullptr;
+    return ++m_task_generation;
+}
+
+
+void KernelApp::start_loading(cc::string const& path, cc::string const& file)
+{
+    auto const generation = next_task_generation();
+    m_is_loading = true;
+    m_is_computing = false;
+
+    m_worker.submit(
+        [this, path, file, generation](std::atomic<bool> const& cancelled)
+        {
+            auto input = std::make_shared<prepared_mesh>();
+            auto const success = prepare_mesh(path, true, *input);
+            if (cancelled)
+                return;
+
+            std::lock_guard lock(m_worker_result_mutex);
+            if (generation != m_task_generation)
+                return;
+
+            if (success)
+                m_mesh_cache.put(path.c_str(), std::make_shared<cached_mesh const>(cached_mesh{input, nullptr, {}}));
+
+            m_load_finished = true;
+            m_loaded_input = success ? std::move(input) : nullptr;
+            m_loaded_input_file = file;
+            m_loaded_input_path = path.c_str();
+        });
+}
+
+
+bool KernelApp::show_cached(std::string const& path, cc::string const& file)
+{
+    auto const entry = m_mesh_cache.get(path);
+    if (!entry)
+        return false;
+
+    // a load or computation of the previous file is obsolete
+    next_task_generation();
+    m_worker.cancel();
+    m_is_loading = false;
+    m_is_computing = false;
+
+    activate_input(entry->input, path, file);
+    if (entry->kernel && entry->options == input_options(*entry->input))
+    {
+        show_kernel_snapshot(entry->kernel);
+        m_profile = entry->kernel;
+        m_renderable_set.get_or_add_renderable_group("input_heat_map").needs_rebuild = true;
+        m_pop_up_shown = true; // only shown for explicit computations
+    }
+    return true;
+}
+
+
+void KernelApp::start_prefetch()
+{
+    m_mesh_cache.set_budget(size_t(tg::max(0, m_cache_budget_mb)) << 20);
+
+    auto const n = int(m_files->size());
+    if (m_prefetch_radius <= 0 || n < 2)
+        return;
+
+    // +1, -1, +2, -2, ... (wrapping like handle_key_events)
+    std::vector<std::string> paths;
+    auto const selected = int(m_selected_item);
+    for (auto k = 1; k <= m_prefetch_radius; ++k)
+        for (auto const sign : {1, -1})
+        {
+            auto const idx = ((selected + sign * k) % n + n) % n;
+            auto const path = cc::format("%s/%s", m_input_directory, (*m_files)[idx].name);
+            if (idx != selected && std::find(paths.begin(), paths.end(), path.c_str()) == paths.end())
+                paths.push_back(path.c_str());
+        }
+
+    m_prefetch_worker.submit(
+        [this, paths, base_options = m_options, min_kernel_volume = m_min_kernel_volume, compute_kernels = m_prefetch_kernels](std::atomic<bool> const& cancelled)
+        {
+            for (auto const& path : paths)
+            {
+                if (cancelled)
+                    return;
+
+                auto const entry = m_mesh_cache.get(path);
+                auto input = entry ? entry->input : nullptr;
+                if (!input)
+                {
+                    auto prepared = std::make_shared<prepared_mesh>();
+                    if (!prepare_mesh(path, true, *prepared))
+                        continue;
+
+                    input = prepared;
+                    m_mesh_cache.put(path, std::make_shared<cached_mesh const>(cached_mesh{input, nullptr, {}}));
+                }
+
+                auto const options = options_for_input(base_options, min_kernel_volume, input->normalize_result, input->upscale_factor);
+                if (!compute_kernels || (entry && entry->kernel && entry->options == options))
+                    continue;
+
+                auto& plane_cut = m_prefetch_plane_cut;
+                plane_cut.set_stop_token(&cancelled);
+                plane_cut.compute_kernel(input->int_position, options);
+                plane_cut.set_stop_token(nullptr);
+
+                if (plane_cut.was_cancelled() || cancelled)
+                    return;
+
+                m_mesh_cache.put(path, std::make_shared<cached_mesh const>(cached_mesh{input, make_kernel_snapshot(plane_cut, input, true), options}));
+            }
+        });
+}
+
+
+void KernelApp::start_kernel_computation()
+{
+    if (!m_active_input)
+        return;
+
+    auto const generation = next_task_generation();
+    m_is_computing = true;
+    m_result_empty = true;
+    m_pop_up_shown = true; // shown again once the final result arrives
+    m_progress_planes_done = 0;
+    m_progress_planes_total = 0;
+
+    m_worker.submit(
+        [this, input = m_active_input, path = m_active_input_path, options = input_options(*m_active_input), generation](std::atomic<bool> const& cancelled)
+        {
+            using clock = std::chrono::steady_clock;
+
+            // rebuilding the renderables is not free, limit the intermediate updates
+            auto const snapshot_interval = std::chrono::milliseconds(250);
+
+            auto const publish = [&](std::shared_ptr<kernel_snapshot const> snapshot)
+            {
+                std::lock_guard lock(m_worker_result_mutex);
+                if (generation == m_task_generation)
+                    m_kernel_snapshot = std::move(snapshot);
+            };
+
+            // emptiness does not depend on the options: a certificate of an earlier run rejects in constant time
+            auto const cached = m_mesh_cache.get(path);
+            if (cached && cached->input == input && cached->kernel && !cached->kernel->certificate_faces.empty()
+                && certificate_holds(input->int_position, cached->kernel->certificate_faces))
+            {
+                auto result = std::make_shared<kernel_snapshot>();
+                result->is_final = true;
+                result->is_empty = true;
+                result->stats.input_faces = int(input->mesh.faces().size());
+                result->certificate_faces = cached->kernel->certificate_faces;
+                m_mesh_cache.put(path, std::make_shared<cached_mesh const>(cached_mesh{input, result, options}));
+                publish(result);
+                return;
+            }
+
+            auto& plane_cut = m_worker_plane_cut;
+            auto last_snapshot = clock::now();
+            plane_cut.set_stop_token(&cancelled);
+            plane_cut.set_progress_callback(
+                [&](size_t done, size_t total)
+                {
+                    m_progress_planes_done = done;
+                    m_progress_planes_total = total;
+
+                    if (clock::now() - last_snapshot < snapshot_interval)
+                        return;
+
+                    publish(make_kernel_snapshot(plane_cut, input, false));
+                    last_snapshot = clock::now();
+                });
+
+            {
+                ct::scope s;
+                plane_cut.compute_kernel(input->int_position, options);
+                ct::write_speedscope_json(s.trace(), "kernel.json");
+            }
+
+            plane_cut.set_progress_callback(nullptr);
+            plane_cut.set_stop_token(nullptr);
+
+            if (plane_cut.was_cancelled() || cancelled)
+                return;
+
+            auto const result = make_kernel_snapshot(plane_cut, input, true);
+            m_mesh_cache.put(path, std::make_shared<cached_mesh const>(cached_mesh{input, result, options}));
+            publish(result);
+        });
+}
+
+
+std::shared_ptr<kernel_snapshot> KernelApp::make_kernel_snapshot(KernelPlaneCut const& plane_cut, std::shared_ptr<prepared_mesh const> const& input, bool is_final)
+{
+    auto snapshot = std::make_shared<kernel_snapshot>();
+    snapshot->is_final = is_final;
+    snapshot->is_empty = is_final && !plane_cut.has_kernel();
+
+    if (is_final)
+    {
+        snapshot->stats = plane_cut.stats();
+        snapshot->plane_costs.assign(plane_cut.plane_costs().begin(), plane_cut.plane_costs().end());
+        for (auto const f : plane_cut.infeasibility_certificate())
+            snapshot->certificate_faces.push_back(int(f.idx.value));
+        if (!snapshot->is_empty && !plane_cut.input_is_convex())
+            for (auto const f : plane_cut.mesh().faces())
+                if (plane_cut.input_face()[f].is_valid())
+                    snapshot->contributing_faces.push_back(int(plane_cut.input_face()[f].idx.value));
+    }
+
+    if (snapshot->is_empty)
+        return snapshot;
+
+    if (plane_cut.input_is_convex())
+        snapshot->input_kernel = input;
+    else
+        plane_cut.copy_result(snapshot->mesh, snapshot->position, input->upscale_factor);
+    return snapshot;
+}
+
+
+void KernelApp::poll_worker_results()
+{
+    auto load_finished = false;
+    std::shared_ptr<prepared_mesh const> input;
+    cc::string input_file;
+    std::string input_path;
+    std::shared_ptr<kernel_snapshot const> snapshot;
+    std::shared_ptr<mesh_lod const> lod;
+    std::shared_ptr<prepared_mesh const> lod_input;
+    {
+        std::lock_guard lock(m_worker_result_mutex);
+        lod = std::move(m_built_lod);
+        lod_input = std::move(m_built_lod_input);
+        load_finished = m_load_finished;
+        m_load_finished = false;
+        input = std::move(m_loaded_input);
+        input_file = m_loaded_input_file;
+        input_path = m_loaded_input_path;
+        snapshot = std::move(m_kernel_snapshot);
+    }
+
+    if (load_finished)
+    {
+        m_is_loading = false;
+        if (input)
+            activate_input(std::move(input), input_path, input_file);
+    }
+
+    // the lod belongs to the active input unless another one was activated while it was built
+    if (lod && lod_input == m_active_input)
+    {
+        m_input_lod = std::move(lod);
+        m_is_building_lod = false;
+    }
+
+    if (snapshot)
+    {
+        show_kernel_snapshot(snapshot);
+
+        if (snapshot->is_final)
+        {
+            m_is_computing = false;
+            m_pop_up_shown = false;
+            m_profile = snapshot;
+            m_renderable_set.get_or_add_renderable_group("input_heat_map").needs_rebuild = true;
+        }
+    }
+}
+
+
+void KernelApp::activate_input(std::shared_ptr<prepared_mesh const> input, std::string const& path, cc::string const& file)
+{
+    // rendered and computed from the shared input, only the frame of the input is taken over
+    m_normalize_result = input->normalize_result;
+    m_upscale_factor = input->upscale_factor;
+    m_load_stats = input->stats;
+    m_shown_input_position = &input->position;
+    m_active_input = std::move(input);
+    m_active_input_path = path;
+    start_lod_build(m_active_input);
+    invalidate_renderable_groups("input");
+
+    m_profile = nullptr;
+    m_renderable_set.get_or_add_renderable_group("input_heat_map").renderables.clear();
 
     m_camera_needs_reset = true;
-    m_loaded_file = m_selected_file;
+    m_loaded_file = file;
+    m_result_empty = true;
     reset_renderable_goup("kernel");
 }
 
 
+void KernelApp::show_kernel_snapshot(std::shared_ptr<kernel_snapshot const> const& snapshot)
+{
+    if (snapshot->is_empty)
+    {
+        reset_renderable_goup("kernel");
+    }
+    else
+    {
+        // snapshots are immutable once published: shown in place instead of copied on the ui thread
+        m_result_snapshot = snapshot;
+        m_result_position = snapshot->input_kernel ? &snapshot->input_kernel->position : &snapshot->position;
+        invalidate_renderable_groups("kernel");
+    }
+
+    if (snapshot->is_final)
+        m_result_empty = snapshot->is_empty;
+}
+
+
 void KernelApp::reset_renderable_goup(cc::string_view name)
 {
     auto& vertex_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_vertices").c_str());
@@ -533,6 +1566,9 @@ void KernelApp::reset_renderable_goup(cc::string_view name)
     vertex_group.renderables.clear();
     edge_group.renderables.clear();
     face_group.renderables.clear();
+    vertex_group.needs_rebuild = false;
+    edge_group.needs_rebuild = false;
+    face_group.needs_rebuild = false;
 }
 
 
@@ -559,6 +1595,12 @@ void KernelApp::handle_imgui()
     ImGui::Checkbox("show input vertices", &input_vertex_group.is_enabled);
     ImGui::Checkbox("show input edges", &input_edge_group.is_enabled);
     ImGui::Checkbox("show input faces", &input_face_group.is_enabled);
+    ImGui::InputInt("render face budget", &m_render_face_budget, 100'000, 1'000'000);
+    if (m_is_building_lod)
+        ImGui::TextUnformatted("building level of detail...");
+    else if (m_input_lod_level >= 0)
+        ImGui::Text("showing lod %d (%d of %d faces)", m_input_lod_level, int(m_input_lod->levels[m_input_lod_level]->mesh.faces().size()),
+                    int(m_shown_input_position->mesh().faces().size()));
 
     // Button to open the new window
     if (ImGui::Button("Select Input Mesh") || m_show_select_mesh_window)
@@ -566,6 +1608,12 @@ void KernelApp::handle_imgui()
         m_show_select_mesh_window = select_mesh_window();
     }
 
+    ImGui::SliderInt("prefetch radius", &m_prefetch_radius, 0, 8);
+    ImGui::Checkbox("prefetch kernels", &m_prefetch_kernels);
+    if (ImGui::InputInt("cache budget (MB)", &m_cache_budget_mb))
+        m_mesh_cache.set_budget(size_t(tg::max(0, m_cache_budget_mb)) << 20);
+    ImGui::Text("cached meshes: %d (%.1f MB)", int(m_mesh_cache.size()), m_mesh_cache.bytes_used() / (1024.0 * 1024.0));
+
     handle_key_events();
 
 
@@ -598,22 +1646,42 @@ void KernelApp::handle_imgui()
     ImGui::Checkbox("show kernel vertices", &kernel_vertex_group.is_enabled);
     ImGui::Checkbox("show kernel edges", &kernel_edge_group.is_enabled);
     ImGui::Checkbox("show kernel faces", &kernel_face_group.is_enabled);
+    ImGui::Checkbox("record per-plane costs", &m_options.record_plane_costs);
+    ImGui::SameLine();
+    if (ImGui::Button("Profiling"))
+        m_show_profiling_window = !m_show_profiling_window;
+    if (m_show_profiling_window)
+        m_show_profiling_window = profiling_window();
 
+    ImGui::BeginDisabled(m_is_loading || !m_active_input);
     if (ImGui::Button("Compute Kernel"))
+        start_kernel_computation();
+    ImGui::EndDisabled();
+
+    if (m_is_loading)
     {
-        if (!m_input_position.empty())
+        ImGui::SameLine();
+        ImGui::TextUnformatted("loading...");
+    }
+
+    if (m_is_computing)
+    {
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel"))
         {
-            compute_mesh_kernel();
-            ct::write_speedscope_json("kernel.json");
-            if (!m_result_empty)
-            {
-                add_renderable_to_groups("kernel", m_current_position);
-            }
-            m_pop_up_shown = false;
+            next_task_generation(); // drop results that are published before the worker notices
+            m_worker.cancel();
+            m_is_computing = false;
+            reset_renderable_goup("kernel");
         }
+
+        auto const total = m_progress_planes_total.load();
+        auto const done = m_progress_planes_done.load();
+        auto const fraction = total > 0 ? float(done) / float(total) : 0.0f;
+        ImGui::ProgressBar(fraction, ImVec2(-1, 0), cc::format("%s / %s planes", done, total).c_str());
     }
 
-    ImGui::BeginDisabled(m_result_empty);
+    ImGui::BeginDisabled(m_result_empty || m_is_computing);
 
     ImGui::InputText("##output_filepath", &m_output_file);
     ImGui::SameLine();
@@ -670,74 +1738,360 @@ void KernelApp::handle_imgui()
 }
 
 
-void KernelApp::add_renderable_to_groups(cc::string_view name, pm::vertex_attribute<tg::dpos3> const& positions)
+bool KernelApp::profiling_window()
 {
-    auto& vertex_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_vertices").c_str());
-    auto& edge_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_edges").c_str());
-    auto& face_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_faces").c_str());
+    auto is_open = true;
+    ImGui::SetNextWindowSize(ImVec2(420, 560), ImGuiCond_FirstUseEver);
+    ImGui::Begin("profiling", &is_open);
+
+    if (!m_profile)
+    {
+        ImGui::TextUnformatted("no finished computation for the current mesh");
+        ImGui::End();
+        return is_open;
+    }
 
-    tg::color3 vertex_color;
-    tg::color3 edge_color;
-    tg::color3 face_color;
+    //* counters and phase timings of the last run
+    auto stats = m_profile->stats; // introspect needs a mutable reference
+    if (ImGui::BeginTable("stats", 2, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+    {
+        introspect(
+            [](auto& value, char const* name)
+            {
+                using T = std::decay_t<decltype(value)>;
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextUnformatted(name);
+                ImGui::TableSetColumnIndex(1);
+                if constexpr (std::is_same_v<T, bool>)
+                    ImGui::TextUnformatted(value ? "true" : "false");
+                else if constexpr (std::is_floating_point_v<T>)
+                    ImGui::Text("%.3f ms", value * 1000.0);
+                else
+                    ImGui::Text("%d", int(value));
+            },
+            stats);
+        ImGui::EndTable();
+    }
 
-    if (name == "input")
+    if (!m_profile->certificate_faces.empty())
     {
-        vertex_color = util::rwth::petrol_100;
-        edge_color = util::rwth::petrol_75;
-        face_color = util::rwth::petrol_50;
+        cc::string faces;
+        for (auto const f : m_profile->certificate_faces)
+            faces += cc::format(faces.empty() ? "%s" : ", %s", f);
+        ImGui::TextWrapped("empty kernel, certificate (input faces): %s", faces.c_str());
     }
-    if (name == "kernel")
+
+    //* timeline of the per-plane cost in cutting order
+    ImGui::SeparatorText("cutting planes");
+    auto const& costs = m_profile->plane_costs;
+    if (costs.empty())
     {
-        vertex_color = util::rwth::may_green_100;
-        edge_color = util::rwth::may_green_75;
-        face_color = util::rwth::may_green_50;
+        ImGui::TextWrapped("enable \"record per-plane costs\" and recompute to see the cost of each cutting plane");
+    }
+    else
+    {
+        int outcome_count[4] = {};
+        auto total_seconds = 0.0;
+        for (auto const& c : costs)
+        {
+            outcome_count[int(c.outcome)]++;
+            total_seconds += c.seconds;
+        }
+
+        // one bar per bucket of consecutive planes
+        auto const bucket_count = int(tg::min(costs.size(), size_t(512)));
+        std::vector<float> timeline(bucket_count, 0.0f);
+        for (size_t i = 0; i < costs.size(); ++i)
+            timeline[i * bucket_count / costs.size()] += costs[i].seconds * 1000.0f;
+
+        auto const overlay = cc::format("%s planes in %s buckets, %s ms", costs.size(), bucket_count, total_seconds * 1000.0);
+        ImGui::PlotHistogram("##timeline", timeline.data(), bucket_count, 0, overlay.c_str(), 0.0f, FLT_MAX, ImVec2(-1, 120));
+        ImGui::Text("concave planes: %d (left of the timeline)", m_profile->stats.number_concave_planes);
+        ImGui::Text("cut: %d  redundant: %d  culled: %d  not processed: %d", outcome_count[int(plane_outcome::cut)],
+                    outcome_count[int(plane_outcome::redundant)], outcome_count[int(plane_outcome::culled)],
+                    outcome_count[int(plane_outcome::not_processed)]);
+
+        // most expensive planes
+        std::vector<int> order(costs.size());
+        for (auto i = 0; i < int(order.size()); ++i)
+            order[i] = i;
+        auto const top = tg::min(order.size(), size_t(8));
+        std::partial_sort(order.begin(), order.begin() + top, order.end(), [&](int a, int b) { return costs[a].seconds > costs[b].seconds; });
+
+        if (ImGui::BeginTable("top planes", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+        {
+            ImGui::TableSetupColumn("plane");
+            ImGui::TableSetupColumn("input face");
+            ImGui::TableSetupColumn("time");
+            ImGui::TableHeadersRow();
+            for (size_t k = 0; k < top; ++k)
+            {
+                auto const& c = costs[order[k]];
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%d", order[k]);
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%d", c.input_face);
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.3f ms", c.seconds * 1000.0f);
+            }
+            ImGui::EndTable();
+        }
     }
 
-    auto const aabb = aabb_of(positions);
-    auto const diag_length = tg::length(aabb.max - aabb.min);
-    auto const line_width = 0.001 * diag_length;
-    auto const point_size = 0.001 * diag_length;
+    //* heat map on the input mesh
+    ImGui::SeparatorText("heat map");
+    auto& heat_map_group = m_renderable_set.get_or_add_renderable_group("input_heat_map");
+    ImGui::Checkbox("show heat map (hide the input faces)", &heat_map_group.is_enabled);
+    char const* heat_map_modes[] = {"plane cost", "plane outcome"};
+    if (ImGui::Combo("color by", &m_heat_map_mode, heat_map_modes, IM_ARRAYSIZE(heat_map_modes)))
+        heat_map_group.needs_rebuild = true;
+
+    if (m_heat_map_mode == 0)
+        ImGui::TextWrapped("yellow: cheap, red: expensive, grey: no cutting plane or not processed");
+    else
+        ImGui::TextWrapped("green: contributed a kernel face, orange: cut, grey: redundant, blue: culled, white: no cutting plane or not processed");
+
+    ImGui::End();
+    return is_open;
+}
+
+
+void KernelApp::build_heat_map(RenderableSet::renderable_group& group)
+{
+    group.renderables.clear();
+    auto const& input_position = *m_shown_input_position;
+    auto const& input_mesh = input_position.mesh();
+    if (!m_profile || input_mesh.faces().empty())
+        return;
+
+    auto const face_count = input_mesh.all_faces().size();
+
+    //* plane of each face (faces merged into a coplanar neighbour have none)
+    std::vector<int> plane_of_face(face_count, -1);
+    auto const& costs = m_profile->plane_costs;
+    for (auto i = 0; i < int(costs.size()); ++i)
+        if (costs[i].input_face >= 0 && size_t(costs[i].input_face) < face_count)
+            plane_of_face[costs[i].input_face] = i;
+
+    std::vector<bool> contributes(face_count, m_profile->stats.is_convex);
+    for (auto const f : m_profile->contributing_faces)
+        if (size_t(f) < face_count)
+            contributes[f] = true;
+
+    //* cost range of the processed planes, colors are interpolated on a log scale
+    auto min_cost = FLT_MAX;
+    auto max_cost = 0.0f;
+    for (auto const& c : costs)
+        if (c.outcome != plane_outcome::not_processed && c.seconds > 0)
+        {
+            min_cost = tg::min(min_cost, c.seconds);
+            max_cost = tg::max(max_cost, c.seconds);
+        }
+    auto const log_range = max_cost > min_cost ? std::log(max_cost / min_cost) : 1.0f;
+
+    auto const color_of = [&](pm::face_handle f) -> tg::color3
+    {
+        auto const plane = plane_of_face[f.idx.value];
+        if (m_heat_map_mode == 1)
+        {
+            if (contributes[f.idx.value])
+                return {0.3f, 0.75f, 0.3f};
+            if (plane < 0)
+                return {0.95f, 0.95f, 0.95f};
+            switch (costs[plane].outcome)
+            {
+            case plane_outcome::cut:
+                return {1.0f, 0.6f, 0.2f};
+            case plane_outcome::redundant:
+                return {0.6f, 0.6f, 0.6f};
+            case plane_outcome::culled:
+                return {0.3f, 0.5f, 0.9f};
+            case plane_outcome::not_processed:
+                break;
+            }
+            return {0.95f, 0.95f, 0.95f};
+        }
+
+        if (plane < 0 || costs[plane].outcome == plane_outcome::not_processed || costs[plane].seconds <= 0)
+            return {0.8f, 0.8f, 0.8f};
+        auto const t = tg::clamp(std::log(costs[plane].seconds / min_cost) / log_range, 0.0f, 1.0f);
+        return {1.0f - 0.2f * t, 0.95f * (1.0f - t), 0.5f * (1.0f - t)}; // light yellow to dark red
+    };
 
     gv::canvas_data canvas_data;
-    canvas_data.set_point_size_world(point_size);
-    canvas_data.add_points(positions).color(vertex_color);
-    vertex_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
-    canvas_data.clear();
+    for (auto const f : input_mesh.faces())
+    {
+        auto const color = color_of(f);
+        auto const he0 = f.any_halfedge();
+        auto const p0 = input_position[he0.vertex_from()];
+        for (auto he = he0.next(); he.vertex_to() != he0.vertex_from(); he = he.next())
+            canvas_data.add_face(p0, input_position[he.vertex_from()], input_position[he.vertex_to()]).color(color);
+    }
+    group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
+}
+
+
+void KernelApp::invalidate_renderable_groups(cc::string_view name)
+{
+    for (auto const* layer : {"_vertices", "_edges", "_faces"})
+    {
+        auto& group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, layer).c_str());
+        group.renderables.clear();
+        group.needs_rebuild = true;
+    }
+}
+
+
+void KernelApp::update_input_lod()
+{
+    auto level = -1;
+    if (m_input_lod && !m_input_lod->levels.empty() && int(m_shown_input_position->mesh().faces().size()) > m_render_face_budget)
+    {
+        // finest level within the budget, the coarsest one if none fits
+        level = int(m_input_lod->levels.size()) - 1;
+        for (auto i = 0; i < int(m_input_lod->levels.size()); ++i)
+            if (int(m_input_lod->levels[i]->mesh.faces().size()) <= m_render_face_budget)
+            {
+                level = i;
+                break;
+            }
+    }
+
+    if (level != m_input_lod_level)
+    {
+        m_input_lod_level = level;
+        invalidate_renderable_groups("input");
+    }
+}
+
+
+void KernelApp::update_renderables()
+{
+    update_input_lod();
+
+    for (auto const* name : {"input", "kernel"})
+    {
+        auto& vertex_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_vertices").c_str());
+        auto& edge_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_edges").c_str());
+        auto& face_group = m_renderable_set.get_or_add_renderable_group(cc::format("%s%s", name, "_faces").c_str());
+
+        auto const needs_vertices = vertex_group.is_enabled && vertex_group.needs_rebuild;
+        auto const needs_edges = edge_group.is_enabled && edge_group.needs_rebuild;
+        auto const needs_faces = face_group.is_enabled && face_group.needs_rebuild;
+        if (!needs_vertices && !needs_edges && !needs_faces)
+            continue;
+
+        pm::vertex_attribute<tg::dpos3> const* positions = m_result_position;
+        tg::color3 vertex_color = util::rwth::may_green_100;
+        tg::color3 edge_color = util::rwth::may_green_75;
+        tg::color3 face_color = util::rwth::may_green_50;
+
+        if (cc::string_view(name) == "input")
+        {
+            // uploading a huge mesh would stall the ui, wait for its lod instead
+            if (m_is_building_lod && int(m_shown_input_position->mesh().faces().size()) > m_render_face_budget)
+                continue;
+
+            positions = m_input_lod_level >= 0 ? &m_input_lod->levels[m_input_lod_level]->position : m_shown_input_position;
+            vertex_color = util::rwth::petrol_100;
+            edge_color = util::rwth::petrol_75;
+            face_color = util::rwth::petrol_50;
+        }
+
+        auto const aabb = aabb_of(*positions);
+        auto const diag_length = tg::length(aabb.max - aabb.min);
+        auto const line_width = 0.001 * diag_length;
+        auto const point_size = 0.001 * diag_length;
+
+        gv::canvas_data canvas_data;
+        if (needs_vertices)
+        {
+            canvas_data.set_point_size_world(point_size);
+            canvas_data.add_points(*positions).color(vertex_color);
+            vertex_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
+            vertex_group.needs_rebuild = false;
+            canvas_data.clear();
+        }
+
+        if (needs_edges)
+        {
+            canvas_data.set_line_width_world(line_width);
+            canvas_data.add_lines(*positions).color(edge_color);
+            edge_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
+            edge_group.needs_rebuild = false;
+            canvas_data.clear();
+        }
+
+        if (needs_faces)
+        {
+            canvas_data.add_faces(*positions).color(face_color);
+            face_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
+            face_group.needs_rebuild = false;
+        }
+    }
+
+    auto& heat_map_group = m_renderable_set.get_or_add_renderable_group("input_heat_map");
+    if (heat_map_group.is_enabled && heat_map_group.needs_rebuild)
+    {
+        build_heat_map(heat_map_group);
+        heat_map_group.needs_rebuild = false;
+    }
+}
+
 
-    canvas_data.set_line_width_world(line_width);
-    canvas_data.add_lines(positions).color(edge_color);
-    edge_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
-    canvas_data.clear();
+void KernelApp::start_lod_build(std::shared_ptr<prepared_mesh const> const& input)
+{
+    m_input_lod = nullptr;
+    m_input_lod_level = -1;
+    m_is_building_lod = false;
 
-    canvas_data.add_faces(positions).color(face_color);
-    face_group.renderables = cc::vector<gv::SharedRenderable>(canvas_data.create_renderables());
+    if (!input || int(input->mesh.faces().size()) <= m_lod_min_input_faces)
+    {
+        m_lod_worker.cancel();
+        return;
+    }
+
+    m_is_building_lod = true;
+    m_lod_worker.submit(
+        [this, input](std::atomic<bool> const& cancelled)
+        {
+            auto lod = build_mesh_lod(input->position, 20'000, &cancelled);
+            if (!lod)
+                return;
+
+            std::lock_guard lock(m_worker_result_mutex);
+            m_built_lod = std::move(lod);
+            m_built_lod_input = input;
+        });
 }
 
 
 void KernelApp::handle_key_events()
 {
-    if (m_input_directory.empty())
+    if (m_input_directory.empty() || m_files->empty())
         return;
     if (ImGui::IsKeyPressed(ImGuiKey_RightArrow))
     {
-        if (m_selected_item == m_obj_files.size() - 1)
+        if (m_selected_item >= m_files->size() - 1)
             m_selected_item = 0;
         else
         {
             m_selected_item++;
         }
-        m_selected_file = m_obj_files[m_selected_item].c_str();
+        m_selected_file = (*m_files)[m_selected_item].name.c_str();
         update_input_mesh();
     }
     if (ImGui::IsKeyPressed(ImGuiKey_LeftArrow))
     {
-        if (m_selected_item == 0)
-            m_selected_item = m_obj_files.size() - 1;
+        if (m_selected_item == 0 || m_selected_item >= m_files->size())
+            m_selected_item = m_files->size() - 1;
         else
         {
             m_selected_item--;
         }
-        m_selected_file = m_obj_files[m_selected_item].c_str();
+        m_selected_file = (*m_files)[m_selected_item].name.c_str();
         update_input_mesh();
     }
 }
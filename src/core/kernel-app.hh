@@ -1,5 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <polymesh/Mesh.hh>
 #include <polymesh/algorithms/normalize.hh>
 
@@ -15,7 +22,13 @@
 #include <integer-plane-geometry/geometry.hh>
 
 // internal
+#include <core/auto-options.hh>
+#include <core/background-worker.hh>
+#include <core/directory-index.hh>
 #include <core/kernel-plane-cut.hh>
+#include <core/mesh-cache.hh>
+#include <core/run-progress.hh>
+#include <rendering/mesh_lod.hh>
 #include <rendering/renderable_set.hh>
 
 namespace mk
@@ -23,6 +36,27 @@ namespace mk
 
 RICH_LOG_DECLARE_DEFAULT_DOMAIN();
 
+struct batch_settings
+{
+    /// stats of all meshes are appended to <stats_path>.csv and <stats_path>.mkstats
+    std::string stats_path;
+
+    /// a speedscope trace is written for every n-th mesh (0 = none)
+    int trace_sample_rate = 100;
+
+    /// a speedscope trace is additionally written for every mesh that takes longer (0 = disabled)
+    double trace_threshold_ms = 1000.0;
+
+    /// infeasibility certificates of empty kernels are stored here and checked before recomputing (empty = disabled)
+    std::string certificate_dir;
+
+    /// OpenMetrics text of the batch is rewritten here (at most once per second and at the end, empty = disabled)
+    std::string metrics_path;
+
+    /// the same text is served on http://127.0.0.1:<port>/metrics while the batch runs (0 = disabled, linux only)
+    int metrics_port = 0;
+};
+
 class KernelApp
 {
 public: // types
@@ -45,22 +79,48 @@ private: // members
     pm::vertex_attribute<tg::ipos3> m_input_int_position{m_input_mesh};
     pm::normalize_result<double> m_normalize_result;
 
+    /// positions of the input that is shown: m_input_position, or the shared m_active_input of the viewer (never copied)
+    pm::vertex_attribute<tg::dpos3> const* m_shown_input_position = &m_input_position;
+
     pm::Mesh m_current_mesh;
     pm::vertex_attribute<tg::dpos3> m_current_position{m_current_mesh};
+
+    /// positions of the kernel that is shown and saved: m_current_position, the shown snapshot, or the input itself if it is convex
+    pm::vertex_attribute<tg::dpos3> const* m_result_position = &m_current_position;
+    std::shared_ptr<kernel_snapshot const> m_result_snapshot; // keeps the shown snapshot (or its convex input) alive
     kernel_options m_options;
 
     bool m_result_empty = true;
 
     double m_upscale_factor = 0.0f;
 
+    load_stats m_load_stats; // of the current input
+
     KernelPlaneCut m_plane_cut;
 
+    /// --auto: options are derived per input from these rules, applied on top of the command line options
+    bool m_auto_options = false;
+    cc::vector<auto_rule> m_auto_rules;
+
+    /// --output-planes: the kernel is written as its bounding planes (.mkplanes), the result mesh is never converted
+    bool m_output_planes = false;
+
+    /// --min-kernel-volume in input units, converted per input to kernel_options::min_kernel_volume (0 = disabled)
+    double m_min_kernel_volume = 0.0;
+
+    /// cli mode: read by the ProgressReporter of run_cli (status line, status file, SIGUSR1)
+    run_progress m_run_progress;
+
 private: // gui
     std::string m_input_directory;
     std::string m_output_directory;
     cc::string m_selected_file;
     cc::string m_loaded_file;
-    cc::vector<std::string> m_obj_files;
+    DirectoryIndex m_directory_index;
+    std::shared_ptr<file_list const> m_files = std::make_shared<file_list const>(); // filtered and sorted view of m_directory_index
+    uint64_t m_files_version = 0;
+    file_view_settings m_file_view_settings;
+    bool m_select_first_file = false; // selects the first file once the scan of a new directory published it
     size_t m_selected_item = 0;
 
     bool m_show_select_mesh_window = false;
@@ -72,6 +132,68 @@ private: // gui
 
     RenderableSet m_renderable_set;
 
+    /// final snapshot of the last computation of the current input, shown in the profiling window
+    std::shared_ptr<kernel_snapshot const> m_profile;
+    bool m_show_profiling_window = false;
+    int m_heat_map_mode = 0; // 0 = plane cost, 1 = plane outcome
+
+private: // background loading and computation (interactive mode only)
+    /// input of the next kernel computation, shared with the worker
+    std::shared_ptr<prepared_mesh const> m_active_input;
+    std::string m_active_input_path;
+
+    /// prepared meshes and kernels of recently visited and prefetched files
+    MeshCache m_mesh_cache;
+    int m_cache_budget_mb = 1024;
+
+    /// the next and previous m_prefetch_radius files of m_files are prepared in the background
+    int m_prefetch_radius = 2;
+    bool m_prefetch_kernels = false;
+
+    /// only accessed by the prefetch worker thread
+    KernelPlaneCut m_prefetch_plane_cut;
+
+    /// only accessed by the worker thread
+    KernelPlaneCut m_worker_plane_cut;
+
+    /// results published by the worker, consumed by poll_worker_results
+    std::mutex m_worker_result_mutex;
+    bool m_load_finished = false;
+    std::shared_ptr<prepared_mesh const> m_loaded_input;
+    cc::string m_loaded_input_file;
+    std::string m_loaded_input_path;
+    std::shared_ptr<kernel_snapshot const> m_kernel_snapshot;
+
+    /// incremented by every submitted task, results of older tasks are dropped
+    std::atomic<uint64_t> m_task_generation = 0;
+
+    std::atomic<size_t> m_progress_planes_done = 0;
+    std::atomic<size_t> m_progress_planes_total = 0;
+
+    bool m_is_loading = false;
+    bool m_is_computing = false;
+
+private: // level of detail of large inputs (interactive mode only)
+    /// inputs with more faces get a clustered lod built in the background
+    int m_lod_min_input_faces = 500'000;
+
+    /// the finest lod level with at most this many faces is displayed
+    int m_render_face_budget = 2'000'000;
+
+    /// lod of m_active_input, null while building or for small inputs
+    std::shared_ptr<mesh_lod const> m_input_lod;
+    int m_input_lod_level = -1; // -1 = full mesh
+    bool m_is_building_lod = false;
+
+    /// published by the lod worker, guarded by m_worker_result_mutex
+    std::shared_ptr<mesh_lod const> m_built_lod;
+    std::shared_ptr<prepared_mesh const> m_built_lod_input;
+
+    /// declared last: join the worker threads before the members above are destroyed
+    BackgroundWorker m_worker;
+    BackgroundWorker m_prefetch_worker;
+    BackgroundWorker m_lod_worker;
+
 private: // helper
     tg::dpos3 cut_coord_to_normalized_coord(tg::dpos3 const& p) { return p / m_upscale_factor; }
     tg::dpos3 normalized_coord_to_cut_coord(tg::dpos3 const& p) { return p * m_upscale_factor; }
@@ -80,25 +202,94 @@ private: // helper
 
     void run_cli(int argc, char** args);
 
-    void run_batch(std::string const& input_path, std::string const& output_path, std::string const& traces_path);
+    void run_batch(std::string const& input_path, std::string const& output_path, std::string const& traces_path, batch_settings const& settings);
+
+    /// runs compute_mesh_kernel repeatedly on the loaded mesh for every option set (list of "key=value,..." overrides of m_options)
+    /// and reports min/median/p95 per phase
+    void run_bench(std::string const& report_path, int runs, int warmup_runs, std::vector<std::string> const& option_sets);
+
+    /// times every AutoCalibration candidate on all obj files of corpus_path (median of runs) and writes the derived rules
+    void run_calibration(std::string const& corpus_path, std::string const& rules_path, int runs);
+
+    /// sets m_options to base_options plus the matching m_auto_rules of the current input, writes the choice to record_path
+    /// (empty = no record)
+    void apply_auto_options(kernel_options const& base_options, std::string const& record_path);
 
     bool load_mesh(cc::string_view const& path, bool normalize = true);
 
+    /// loads, normalizes and quantizes without touching the app state (safe to call from the worker)
+    bool prepare_mesh(cc::string_view const& path, bool normalize, prepared_mesh& result);
+
+    /// copies a prepared mesh into m_input_* (cli modes, the viewer shows and computes from the shared prepared mesh)
+    void set_input_mesh(prepared_mesh const& input);
+
     void compute_mesh_kernel();
 
-    pm::vertex_attribute<tg::dpos3> to_dpos(pm::vertex_attribute<point4_t> const& vertex_points);
+    /// m_options with --min-kernel-volume converted for the current / the given input, m_options itself is never rescaled
+    kernel_options input_options() const;
+    kernel_options input_options(prepared_mesh const& input) const;
+
+    /// true if the certificate stored at path proves that the current input has an empty kernel (sets the result to empty)
+    bool check_certificate(std::string const& path);
+
+    /// stores the certificate of the last compute_mesh_kernel at path, removes a stale one if the kernel is not empty
+    void update_certificate(std::string const& path);
+
+    /// loads the given file on the worker, cancels a running computation
+    void start_loading(cc::string const& path, cc::string const& file);
+
+    /// computes the kernel of m_active_input on the worker and publishes intermediate polytopes
+    void start_kernel_computation();
+
+    /// prepares (and optionally computes the kernels of) the files around m_selected_item into m_mesh_cache
+    void start_prefetch();
+
+    /// shows a cached input (and kernel) immediately, returns false if path is not cached
+    bool show_cached(std::string const& path, cc::string const& file);
+
+    /// makes the given input the current one and updates the input renderables, ui thread only
+    void activate_input(std::shared_ptr<prepared_mesh const> input, std::string const& path, cc::string const& file);
+
+    /// updates the kernel renderables, ui thread only
+    void show_kernel_snapshot(std::shared_ptr<kernel_snapshot const> const& snapshot);
+
+    /// converts the current state of a plane cut to a snapshot
+    std::shared_ptr<kernel_snapshot> make_kernel_snapshot(KernelPlaneCut const& plane_cut, std::shared_ptr<prepared_mesh const> const& input, bool is_final);
+
+    /// invalidates all pending worker results, returns the generation of the next task
+    uint64_t next_task_generation();
+
+    /// takes over loaded meshes and kernel snapshots of the worker, ui thread only
+    void poll_worker_results();
 
     void handle_imgui();
 
     bool select_mesh_window();
 
-    void fetch_obj_files();
+    /// stats and per-plane timeline of m_profile
+    bool profiling_window();
+
+    /// colors the input faces by the cost or outcome of the cutting plane they generated
+    void build_heat_map(RenderableSet::renderable_group& group);
+
+    /// takes over a new view of m_directory_index and keeps the selection, ui thread only
+    void poll_directory_index();
 
     void update_input_mesh();
 
     void init_renderable_set();
 
-    void add_renderable_to_groups(cc::string_view name, pm::vertex_attribute<tg::dpos3> const& positions);
+    /// clears the renderables of the given name, they are rebuilt by update_renderables once their group is enabled
+    void invalidate_renderable_groups(cc::string_view name);
+
+    /// (re)builds the renderables of enabled groups whose content changed, ui thread only
+    void update_renderables();
+
+    /// chooses the lod level of the input for m_render_face_budget, invalidates the input groups if it changed
+    void update_input_lod();
+
+    /// builds the lod of the given input on the lod worker if it is large enough
+    void start_lod_build(std::shared_ptr<prepared_mesh const> const& input);
 
     void reset_renderable_goup(cc::string_view name);
 
@@ -107,6 +298,12 @@ private: // helper
     void trace_full_computation();
 
     void save_kernel(cc::string_view filepath);
+
+    /// writes the distinct supporting planes of the kernel, see kernel-planes.hh
+    void save_kernel_planes(std::string const& filepath);
+
+    /// writes uniform random points inside the current kernel as "x y z" lines in input coordinates
+    void save_kernel_samples(std::string const& filepath, int count, uint64_t seed, bool use_hit_and_run);
 };
 
 } // namespace mk
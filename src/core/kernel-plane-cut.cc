@@ -1,5 +1,7 @@
 #include "kernel-plane-cut.hh"
 
+#include <chrono>
+
 #include <clean-core/indices_of.hh>
 #include <clean-core/set.hh>
 #include <clean-core/vector.hh>
@@ -34,6 +36,7 @@
 #endif
 
 // internal
+#include <core/hot-path-log.hh>
 #include <core/kdop.hh>
 
 namespace
@@ -59,6 +62,75 @@ ScalarT to_cgal(tg::fixed_int<2> v)
     r *= s;
     return r;
 }
+
+/// measures the wall clock time between consecutive calls of lap()
+struct phase_timer
+{
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point start = clock::now();
+    clock::time_point last = start;
+
+    double lap()
+    {
+        auto const now = clock::now();
+        auto const seconds = std::chrono::duration<double>(now - last).count();
+        last = now;
+        return seconds;
+    }
+
+    double total() const { return std::chrono::duration<double>(clock::now() - start).count(); }
+};
+
+/// relative drift of the running volume, only decides when the volume is measured again from the exact positions
+constexpr double volume_tolerance = 1e-9;
+
+struct polygon_measure
+{
+    double volume = 0.0;     // of the cone from origin over the polygon, signed by its orientation
+    double abs_volume = 0.0; // sum of the unsigned fan terms, scales the rounding error
+    double area = 0.0;
+};
+
+/// fan triangulated measure of a face, position(v) returns a tg::dpos3
+template <class PosF>
+polygon_measure measure_polygon(pm::face_handle face, tg::dpos3 const& origin, PosF const& position)
+{
+    polygon_measure m;
+    auto const h0 = face.any_halfedge();
+    auto const p0 = position(h0.vertex_from()) - origin;
+    auto normal = tg::dvec3::zero;
+    for (auto h = h0.next(); h.next() != h0; h = h.next())
+    {
+        auto const p1 = position(h.vertex_from()) - origin;
+        auto const p2 = position(h.vertex_to()) - origin;
+        auto const v = tg::dot(p0, tg::cross(p1, p2)) / 6;
+        m.volume += v;
+        m.abs_volume += tg::abs(v);
+        normal += tg::cross(p1 - p0, p2 - p0);
+    }
+    m.area = tg::length(normal) / 2;
+    return m;
+}
+
+/// volume (signed by the face orientation) and area of a closed polytope
+template <class PosF>
+polygon_measure measure_polytope(pm::Mesh const& mesh, PosF const& position)
+{
+    polygon_measure m;
+    if (mesh.vertices().empty())
+        return m;
+
+    auto const origin = position(mesh.vertices().first());
+    for (auto const f : mesh.faces())
+    {
+        auto const face = measure_polygon(f, origin, position);
+        m.volume += face.volume;
+        m.abs_volume += face.abs_volume;
+        m.area += face.area;
+    }
+    return m;
+}
 }
 
 namespace mk
@@ -74,7 +146,10 @@ void KernelPlaneCut::compute_kernel(pm::vertex_attribute<pos_t> const& input_pos
 {
     reset();
 
+    phase_timer timer;
+
     m_options = options;
+    m_input_positions = &input_positions;
 
     m_benchmark_data.input_faces = input_positions.mesh().faces().size();
 
@@ -85,8 +160,16 @@ void KernelPlaneCut::compute_kernel(pm::vertex_attribute<pos_t> const& input_pos
     {
         TRACE("complete kernel construction");
 
+        report_phase(run_phase::input_planes);
         init_input_planes(input_positions);
+        m_benchmark_data.time_input_planes_seconds = timer.lap();
+
+        report_phase(run_phase::edge_state);
         init_edge_state(input_positions);
+        m_benchmark_data.time_edge_state_seconds = timer.lap();
+
+        if (should_stop())
+            return;
 
         if (is_convex())
         {
@@ -96,9 +179,18 @@ void KernelPlaneCut::compute_kernel(pm::vertex_attribute<pos_t> const& input_pos
             m_benchmark_data.total_planes = m_benchmark_data.input_faces;
             m_has_kernel = true;
             m_input_is_convex = true;
+            if (m_options.min_kernel_volume > 0)
+            {
+                auto const m = measure_polytope(input_positions.mesh(), [&](pm::vertex_handle v) { return tg::dpos3(input_positions[v]); });
+                report_kernel_volume(tg::abs(m.volume), m.area);
+                m_has_kernel = !m_benchmark_data.kernel_too_small;
+            }
+            m_benchmark_data.time_total_seconds = timer.total();
+            report_phase(run_phase::idle);
             return;
         }
 
+        report_phase(run_phase::cutting_planes);
         m_cutting_planes.reserve(input_positions.mesh().faces().size());
 
         if (m_options.use_unordered_set)
@@ -111,27 +203,86 @@ void KernelPlaneCut::compute_kernel(pm::vertex_attribute<pos_t> const& input_pos
 
         m_benchmark_data.total_planes = m_cutting_planes.size();
         m_benchmark_data.number_concave_planes = m_number_concave_planes;
+        m_benchmark_data.time_cutting_planes_seconds = timer.lap();
+
+        if (should_stop())
+            return;
 
-        if (m_options.parallel_exact_lp)
+        if (m_options.record_cut_log)
+            begin_cut_log(tg::aabb_of(input_positions));
+
+        if (m_run_progress != nullptr)
+            m_run_progress->planes_total.store(m_cutting_planes.size(), std::memory_order_relaxed);
+
+        // tiny inputs: the thread of the exact LP and the setup of the halfedge structure cost more than the cutting
+        auto const small_input = m_options.small_mesh_max_faces > 0 && m_benchmark_data.input_faces <= m_options.small_mesh_max_faces;
+        if (small_input)
+            report_phase(run_phase::cutting);
+        if (small_input && compute_small_mesh_kernel(tg::aabb_of(input_positions)))
         {
-            m_exact_seidel_solver_result = std::async(std::launch::async,
-                                                      [this]()
-                                                      {
-                                                          m_exact_seidel_solver.set_planes(m_cutting_planes);
-                                                          return m_exact_seidel_solver.solve();
-                                                      });
+            m_benchmark_data.small_mesh_path = true;
+            m_cut_log.small_mesh_path = m_options.record_cut_log;
+            m_benchmark_data.time_cutting_seconds = timer.lap();
         }
+        else
+        {
+            if (m_was_cancelled)
+                return;
 
-        init_supporting_structure(input_positions);
+            if (m_options.parallel_exact_lp)
+            {
+                m_exact_seidel_solver.reset_stop();
+                if (m_run_progress != nullptr)
+                    m_run_progress->lp.store(lp_state::running, std::memory_order_relaxed);
+                m_exact_seidel_solver_result = std::async(std::launch::async,
+                                                          [this, progress = m_run_progress]()
+                                                          {
+                                                              m_exact_seidel_solver.set_planes(m_cutting_planes);
+                                                              auto const state = m_exact_seidel_solver.solve();
+                                                              if (progress != nullptr)
+                                                                  progress->lp.store(state == ExactSeidelSolverPoint::state::infeasible
+                                                                                         ? lp_state::infeasible
+                                                                                         : lp_state::feasible,
+                                                                                     std::memory_order_relaxed);
+                                                              return state;
+                                                          });
+            }
 
-        compute_mesh_kernel();
+            report_phase(run_phase::supporting_structure);
+            init_supporting_structure(input_positions);
+            m_benchmark_data.time_supporting_structure_seconds = timer.lap();
+
+            if (should_stop())
+                return;
+
+            report_phase(run_phase::cutting);
+            compute_mesh_kernel();
+            m_benchmark_data.time_cutting_seconds = timer.lap();
+        }
+
+        if (m_was_cancelled)
+            return;
     }
 
+    report_phase(run_phase::finalize);
     LOGD(Default, Info, "number of cutting planes: %s", m_cutting_planes.size());
 
+    // the running volume only decides the early out, the reported one is summed up again
+    if (m_has_kernel && m_options.min_kernel_volume > 0)
+    {
+        auto const m = measure_polytope(m_mesh, [&](pm::vertex_handle v) { return ipg::to_dpos3(m_position_point4[v]); });
+        report_kernel_volume(tg::abs(m.volume), m.area);
+        m_has_kernel = !m_benchmark_data.kernel_too_small;
+    }
+
     if (!m_has_kernel)
     {
-        LOGD(Default, Info, "kernel is empty!");
+        if (m_benchmark_data.clip_failed)
+            LOGD(Default, Warning, "clipping failed, no kernel!");
+        else if (m_benchmark_data.kernel_too_small)
+            LOGD(Default, Info, "kernel is smaller than the minimum volume!");
+        else
+            LOGD(Default, Info, "kernel is empty!");
         m_mesh.clear();
     }
 
@@ -170,12 +321,160 @@ void KernelPlaneCut::compute_kernel(pm::vertex_attribute<pos_t> const& input_pos
             }
         }
     }
+
+    m_benchmark_data.time_finalize_seconds = timer.lap();
+    m_benchmark_data.time_total_seconds = timer.total();
+    report_phase(run_phase::idle);
+}
+
+KernelPlaneCut::result_view KernelPlaneCut::result() const
+{
+    result_view view;
+    view.is_empty = !m_has_kernel;
+    if (view.is_empty)
+        return view;
+
+    view.is_input = m_input_is_convex;
+    if (view.is_input)
+    {
+        view.mesh = &m_input_positions->mesh();
+        view.input_positions = m_input_positions;
+    }
+    else
+    {
+        view.mesh = &m_mesh;
+        view.points = &m_position_point4;
+    }
+    return view;
+}
+
+void KernelPlaneCut::copy_result(pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position, double upscale_factor) const
+{
+    CC_ASSERT(!m_input_is_convex && "convex inputs are their own kernel, see result()");
+
+    // same indices as m_mesh, removed elements included
+    mesh.copy_from(m_mesh);
+    position = pm::vertex_attribute<tg::dpos3>(mesh);
+    for (auto const v : m_mesh.vertices())
+        position[mesh.vertices()[v.idx.value]] = ipg::to_dpos3(m_position_point4[v]) / upscale_factor;
+}
+
+cc::vector<kernel_plane> KernelPlaneCut::kernel_planes() const
+{
+    cc::vector<kernel_plane> planes;
+    if (!m_has_kernel)
+        return planes;
+
+    // faces split by a cut (and triangulated faces) share their plane
+    cc::set<plane_t> seen;
+    auto const add_plane = [&](plane_t const& p, pm::face_handle input_face)
+    {
+        if (seen.contains(p))
+            return;
+        seen.add(p);
+        planes.push_back({p, input_face.is_valid() ? int(input_face.idx.value) : -1});
+    };
+
+    if (m_input_is_convex)
+    {
+        for (auto const f : m_input_positions->mesh().faces())
+            if (m_input_plane[f].is_valid())
+                add_plane(m_input_plane[f], f);
+    }
+    else
+    {
+        for (auto const f : m_mesh.faces())
+            add_plane(m_supporting_plane[f], m_input_face[f]);
+    }
+    return planes;
+}
+
+void KernelPlaneCut::replay(cut_log const& log, bool record_log)
+{
+    reset();
+
+    phase_timer timer;
+
+    m_options = {};
+    m_options.use_bb_culling = log.use_bb_culling;
+    m_options.kdop_k = log.kdop_k;
+    m_options.parallel_exact_lp = false; // replaced by the recorded early out
+    m_replay_lp_early_out_plane = log.lp_early_out_plane;
+    m_options.record_cut_log = record_log;
+
+    m_input_is_convex = false;
+    m_input_positions = nullptr;
+    m_cutting_planes = log.planes;
+    for (size_t i = 0; i < log.planes.size(); ++i)
+        m_face_of_plane.push_back(pm::face_handle::invalid); // the input mesh is not part of the log
+    m_number_concave_planes = size_t(log.number_concave_planes);
+
+    m_benchmark_data.total_planes = m_cutting_planes.size();
+    m_benchmark_data.number_concave_planes = m_number_concave_planes;
+
+    auto const box = aabb_t(log.box_min, log.box_max);
+    if (record_log)
+    {
+        begin_cut_log(box);
+        m_cut_log.input_faces = log.input_faces;
+    }
+
+    if (log.small_mesh_path && compute_small_mesh_kernel(box))
+    {
+        m_benchmark_data.small_mesh_path = true;
+        m_cut_log.small_mesh_path = record_log;
+    }
+    else
+    {
+        init_supporting_structure(box);
+        m_benchmark_data.time_supporting_structure_seconds = timer.lap();
+
+        compute_mesh_kernel();
+    }
+    m_benchmark_data.time_cutting_seconds = timer.lap();
+
+    m_replay_lp_early_out_plane = -1;
+
+    if (!m_has_kernel)
+        m_mesh.clear();
+    else
+        m_benchmark_data.kernel_faces = m_mesh.faces().size();
+
+    m_benchmark_data.time_total_seconds = timer.total();
+}
+
+void KernelPlaneCut::begin_cut_log(aabb_t const& aabb)
+{
+    m_cut_log.use_bb_culling = m_options.use_bb_culling;
+    m_cut_log.kdop_k = m_options.kdop_k;
+    m_cut_log.box_min = aabb.min;
+    m_cut_log.box_max = aabb.max;
+    m_cut_log.planes = m_cutting_planes;
+    for (auto const f : m_face_of_plane)
+    {
+        m_cut_log.input_faces.push_back(int(f.idx.value));
+        m_cut_log.outcomes.push_back(plane_outcome::not_processed);
+    }
+    m_cut_log.number_concave_planes = int(m_number_concave_planes);
 }
 
 void KernelPlaneCut::reset()
 {
+    // the solver of a previous (cancelled) run might still be running on the same solver object
+    if (m_exact_seidel_solver_result.valid())
+    {
+        m_exact_seidel_solver.stop();
+        m_exact_seidel_solver_result.wait();
+        m_exact_seidel_solver_result = {};
+    }
+
     m_cutting_planes.clear();
     m_face_of_plane.clear();
+    m_plane_costs.clear();
+    m_certificate.clear();
+    m_certificate_pending = false;
+    m_cut_log = {};
+    m_recent_cuts.clear();
 
     m_has_kernel = false;
     m_input_is_convex = true; // it's convex until we find an edge that says otherwise
@@ -189,8 +488,42 @@ void KernelPlaneCut::reset()
     m_12dop = {};
     m_c0_vertices.clear();
 
+    m_track_volume = false;
+    m_volume = 0.0;
+    m_area = 0.0;
+    m_volume_error = 0.0;
+
     m_has_queried_future = false;
     m_is_infeasible = false;
+    m_was_cancelled = false;
+
+    if (m_run_progress != nullptr)
+    {
+        m_run_progress->planes_done.store(0, std::memory_order_relaxed);
+        m_run_progress->planes_total.store(0, std::memory_order_relaxed);
+        m_run_progress->lp.store(lp_state::not_started, std::memory_order_relaxed);
+    }
+}
+
+void KernelPlaneCut::report_phase(run_phase phase)
+{
+    if (m_run_progress == nullptr)
+        return;
+
+    m_run_progress->publish(m_benchmark_data);
+    m_run_progress->phase.store(phase, std::memory_order_relaxed);
+}
+
+bool KernelPlaneCut::should_stop()
+{
+    if (m_stop == nullptr || !m_stop->load(std::memory_order_relaxed))
+        return false;
+
+    m_was_cancelled = true;
+    m_has_kernel = false;
+    m_exact_seidel_solver.stop();
+    m_mesh.clear();
+    return true;
 }
 
 
@@ -526,12 +859,41 @@ bool KernelPlaneCut::is_infeasible()
         {
             LOGD(Default, Debug, "Finished Seidel Solver before all planes are processed");
             m_is_infeasible = true;
+            set_certificate(m_exact_seidel_solver.infeasible_subset());
         }
         m_has_queried_future = true; // don't query the future twice!
     }
     return m_is_infeasible;
 }
 
+void KernelPlaneCut::set_certificate(cc::span<int const> plane_indices) const
+{
+    m_certificate.clear();
+    for (auto const idx : plane_indices)
+        m_certificate.push_back(m_face_of_plane[idx]);
+}
+
+cc::vector<pm::face_handle> const& KernelPlaneCut::infeasibility_certificate() const
+{
+    if (!m_certificate_pending)
+        return m_certificate;
+    m_certificate_pending = false;
+
+    // the kernel lies inside the box, so the LP of all cutting planes is infeasible whenever the clipper emptied the box
+    // the parallel solver was not stopped on this path and is still (or was) solving exactly that LP
+    if (m_exact_seidel_solver_result.valid() && m_exact_seidel_solver_result.get() == ExactSeidelSolverPoint::state::infeasible)
+    {
+        set_certificate(m_exact_seidel_solver.infeasible_subset());
+        return m_certificate;
+    }
+
+    ExactSeidelSolverPoint solver;
+    solver.set_planes(m_cutting_planes);
+    if (solver.solve() == ExactSeidelSolverPoint::state::infeasible)
+        set_certificate(solver.infeasible_subset());
+    return m_certificate;
+}
+
 
 typename KernelPlaneCut::plane_t KernelPlaneCut::face_to_plane(pm::face_handle const& face_handle, pm::vertex_attribute<pos_t> const& positions)
 {
@@ -551,16 +913,15 @@ typename KernelPlaneCut::plane_t KernelPlaneCut::face_to_plane(pm::face_handle c
 /**
  * @brief converts the mesh into a cube fitting the aabb.
  *
- * This function resets the given mesh and adds a cube fitting the axis-aligned bounding box (AABB) of the initial positions.
+ * This function resets the given mesh and adds a cube fitting the given axis-aligned bounding box (AABB).
  *
- * @tparam pos_t The type representing the position of a vertex.
+ * @param aabb The box, the aabb of the input positions (or the box of a replayed cut log).
  * @param mesh The mesh to add the cube.
- * @param int_positions The vertex attribute containing the positions to be scaled.
+ * @param output_position The vertex attribute receiving the corner positions.
  */
-void KernelPlaneCut::init_with_aabb(pm::vertex_attribute<pos_t> const& input_position, pm::Mesh& mesh, pm::vertex_attribute<pos_t>& output_position)
+void KernelPlaneCut::init_with_aabb(aabb_t const& aabb, pm::Mesh& mesh, pm::vertex_attribute<pos_t>& output_position)
 {
     mesh.clear();
-    auto const aabb = tg::aabb_of(input_position);
     auto const size = tg::size_of(aabb);
     pm::objects::add_cube(mesh,
                           [&](pm::vertex_handle v, int x, int y, int z)
@@ -609,13 +970,16 @@ void KernelPlaneCut::set_edge_lines(pm::vertex_attribute<pos_t> const& positions
 }
 
 
-void KernelPlaneCut::init_supporting_structure(pm::vertex_attribute<pos_t> const& position)
+void KernelPlaneCut::init_supporting_structure(pm::vertex_attribute<pos_t> const& position) { init_supporting_structure(tg::aabb_of(position)); }
+
+
+void KernelPlaneCut::init_supporting_structure(aabb_t const& aabb)
 {
     // TRACE();
     m_mesh.clear();
 
     //* start with aabb cube of mesh
-    init_with_aabb(position, m_mesh, m_initial_position);
+    init_with_aabb(aabb, m_mesh, m_initial_position);
 
     init_point4_position(m_initial_position);
     set_edge_lines(m_initial_position);
@@ -978,10 +1342,28 @@ bool KernelPlaneCut::delete_c1_vertices()
     stack.push_back(initial_c1_vertex);
     m_visited_c1_vertex[initial_c1_vertex] = true;
 
+    // the faces around the removed vertices and the hole face bound the cap, the hole face lies in the cutting plane
+    // and does not contribute to the volume of the cones from a point on the plane
+    auto const origin = m_position_dpos[m_c0_vertex];
+    auto const dpos = [&](pm::vertex_handle v) { return m_position_dpos[v]; };
+
     while (!stack.empty())
     {
         auto const current_vertex = stack.get_and_pop_back();
 
+        if (m_track_volume)
+            for (auto const f : current_vertex.faces())
+            {
+                if (f.is_invalid() || m_is_cap_face[f])
+                    continue;
+                m_is_cap_face[f] = true;
+
+                auto const cap = measure_polygon(f, origin, dpos);
+                m_volume -= cap.volume;
+                m_volume_error += volume_tolerance * cap.abs_volume;
+                m_area -= cap.area;
+            }
+
         for (auto neighbor : current_vertex.adjacent_vertices())
         {
             if (m_is_c0_vertex[neighbor] || m_visited_c1_vertex[neighbor])
@@ -1012,6 +1394,16 @@ void KernelPlaneCut::fill_cut_hole()
     auto const new_face = m_mesh.faces().fill(first_halfedge);
     m_supporting_plane[new_face] = m_cutting_plane;
     m_input_face[new_face] = m_cutting_plane_original_face;
+
+    if (m_track_volume)
+        m_area += measure_polygon(new_face, m_position_dpos[m_c0_vertices[0]], [&](pm::vertex_handle v) { return m_position_dpos[v]; }).area;
+}
+
+void KernelPlaneCut::report_kernel_volume(double volume, double area)
+{
+    m_benchmark_data.kernel_volume = volume;
+    m_benchmark_data.kernel_inradius_bound = area > 0 ? 3 * volume / area : 0.0;
+    m_benchmark_data.kernel_too_small = volume < m_options.min_kernel_volume;
 }
 
 
@@ -1086,7 +1478,7 @@ pm::halfedge_handle KernelPlaneCut::skip_non_intersecting_faces(pm::halfedge_han
 }
 
 
-void KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
+bool KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
 {
     CC_ASSERT(classify(start_halfedge.vertex_to(), m_cutting_plane) == 0
               || classify(start_halfedge.vertex_from(), m_cutting_plane) != classify(start_halfedge.vertex_to(), m_cutting_plane));
@@ -1097,10 +1489,17 @@ void KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
     pm::vertex_handle current_c0_vertex = pm::vertex_handle::invalid;
     pm::vertex_handle prev_c0_vertex = pm::vertex_handle::invalid;
 
+    //* every face is entered at most once and every halfedge walked at most once, splits add a few halfedges per face
+    auto const max_steps = 4 * m_mesh.halfedges().size() + 16;
+    auto steps = size_t(0);
+
     //* march along the cutting plane placing c0 vertices on intersections
     do
     {
-        LOGD(Default, Trace, "current halfedge %s;  start_halfedge %s", current_halfedge.idx.value, start_halfedge.idx.value);
+        if (++steps > max_steps)
+            return false;
+
+        MK_HOT_LOG_TRACE("current halfedge %s;  start_halfedge %s", current_halfedge.idx.value, start_halfedge.idx.value);
         auto pointA = m_position_point4(current_halfedge.vertex_from());
         auto pointB = m_position_point4(current_halfedge.vertex_to());
         auto cA = ipg::classify(pointA, m_cutting_plane);
@@ -1110,6 +1509,9 @@ void KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
         auto const first_he = current_halfedge;
         while (!signs_different(current_halfedge) || cA == 0)
         {
+            if (++steps > max_steps)
+                return false;
+
             current_halfedge = current_halfedge.next();
 
             pointA = m_position_point4(current_halfedge.vertex_from());
@@ -1125,7 +1527,7 @@ void KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
 
             //* break if we have a full loop
             if (current_halfedge == first_he)
-                return; // changed this from break to return, hope this doesnt break anything, but i had an infinite loop here with 314438.obj
+                return true; // changed this from break to return, hope this doesnt break anything, but i had an infinite loop here with 314438.obj
         }
 
         //* if on different sides of the plane split halfedge
@@ -1158,6 +1560,220 @@ void KernelPlaneCut::marching(pm::halfedge_handle const& start_halfedge)
 
     // since current_c0_vertex != m_c0_vertices.front() the first one gets added twice
     m_c0_vertices.pop_back();
+    return true;
+}
+
+KernelPlaneCut::clip_result KernelPlaneCut::clip_full_scan()
+{
+    MK_HOT_TRACE("clip-full-scan");
+
+    // the partial march only split edges and faces at the plane, the geometry is unchanged
+    m_is_c0_vertex.clear();
+    m_c0_vertices.clear();
+    m_c0_vertex = pm::vertex_handle::invalid;
+
+    //* classify every vertex once, in the lane-parallel layout
+    m_batch_points.clear();
+    for (auto const v : m_mesh.all_vertices())
+        m_batch_points.push_back(m_position_point4[v]);
+    m_vertex_batch.assign(m_batch_points);
+
+    cc::vector<tg::i8> sign;
+    sign.resize(m_batch_points.size());
+    m_vertex_batch.classify(m_cutting_plane, sign);
+
+    pm::vertex_attribute<tg::i8> side(m_mesh);
+    auto has_positive_vertex = false;
+    auto has_negative_vertex = false;
+    for (auto const v : m_mesh.vertices())
+    {
+        side[v] = sign[v.idx.value];
+        has_positive_vertex |= side[v] > 0;
+        has_negative_vertex |= side[v] < 0;
+    }
+    if (!has_positive_vertex)
+        return clip_result::redundant;
+    if (!has_negative_vertex)
+        return clip_result::empty;
+
+    //* split all edges with a strict sign change, the new vertices are on the plane (side 0)
+    cc::vector<pm::halfedge_handle> crossing;
+    for (auto const e : m_mesh.edges())
+        if (side[e.vertexA()] * side[e.vertexB()] == -1)
+            crossing.push_back(e.halfedgeA());
+    for (auto const h : crossing)
+        split_halfedge(h);
+
+    for (auto const v : m_mesh.vertices())
+        m_is_c0_vertex[v] = side[v] == 0;
+
+    //* split all faces with vertices on both sides between their two vertices on the plane
+    cc::vector<pm::face_handle> faces;
+    for (auto const f : m_mesh.faces())
+        faces.push_back(f);
+    for (auto const f : faces)
+    {
+        auto positive = false;
+        auto negative = false;
+        pm::vertex_handle on_plane[2];
+        auto on_plane_count = 0;
+        for (auto const v : f.vertices())
+        {
+            positive |= side[v] > 0;
+            negative |= side[v] < 0;
+            if (side[v] == 0 && on_plane_count < 2)
+                on_plane[on_plane_count++] = v;
+        }
+        if (positive && negative && on_plane_count == 2 && !pm::are_adjacent(on_plane[0], on_plane[1]))
+            split_face(on_plane[0], on_plane[1], f);
+    }
+
+    //* cap edges: both vertices on the plane, the face has a positive vertex and the opposite face does not
+    auto const face_is_positive = [&](pm::face_handle f) { return f.is_valid() && f.vertices().any([&](auto v) { return side[v] > 0; }); };
+    auto const is_cap_halfedge = [&](pm::halfedge_handle h)
+    {
+        return side[h.vertex_from()] == 0 && side[h.vertex_to()] == 0 && face_is_positive(h.face()) && !face_is_positive(h.opposite_face());
+    };
+
+    auto first = pm::halfedge_handle::invalid;
+    for (auto const h : m_mesh.halfedges())
+        if (is_cap_halfedge(h))
+        {
+            first = h;
+            break;
+        }
+    if (first.is_invalid())
+    {
+        LOGD(Default, Warning, "full scan clip found no cap edge");
+        return clip_result::failed;
+    }
+
+    //* walk the cap loop, at most one step per vertex
+    auto current = first;
+    auto const max_steps = m_mesh.vertices().size();
+    for (size_t step = 0; step < max_steps; ++step)
+    {
+        m_c0_vertices.push_back(current.vertex_from());
+
+        auto next = pm::halfedge_handle::invalid;
+        for (auto const h : current.vertex_to().outgoing_halfedges())
+            if (h != current.opposite() && is_cap_halfedge(h))
+            {
+                next = h;
+                break;
+            }
+
+        if (next.is_invalid())
+        {
+            LOGD(Default, Warning, "full scan clip found an open cap");
+            return clip_result::failed;
+        }
+        if (next == first)
+        {
+            m_c0_vertex = first.vertex_from();
+            return clip_result::cut;
+        }
+        current = next;
+    }
+
+    LOGD(Default, Warning, "full scan clip did not close the cap");
+    return clip_result::failed;
+}
+
+bool KernelPlaneCut::compute_small_mesh_kernel(aabb_t const& aabb)
+{
+    if (!m_small_polytope.init_box(aabb.min, aabb.max))
+        return false;
+
+    // intermediate states are not available on this path
+    m_mesh.clear();
+
+    using clock = std::chrono::steady_clock;
+    auto const record_costs = m_options.record_plane_costs;
+    if (record_costs)
+        for (auto const f : m_face_of_plane)
+            m_plane_costs.push_back({int(f.idx.value), 0.0f, plane_outcome::not_processed});
+
+    //* same bookkeeping as compute_mesh_kernel, so stats, costs and cut logs of both paths can be compared
+    auto const record_log = m_options.record_cut_log;
+    auto const record_outcome = [&](size_t i, plane_outcome outcome, clock::time_point plane_start)
+    {
+        m_recent_cuts.push({int(i), outcome, m_small_polytope.vertex_count(), int(m_small_polytope.faces().size())});
+        if (record_log)
+            m_cut_log.outcomes[i] = outcome;
+        if (!record_costs)
+            return;
+        m_plane_costs[i].seconds = std::chrono::duration<float>(clock::now() - plane_start).count();
+        m_plane_costs[i].outcome = outcome;
+    };
+
+    for (size_t i = 0; i < m_cutting_planes.size(); i++)
+    {
+        if (should_stop())
+            return true;
+
+        if (m_progress_callback)
+            m_progress_callback(i, m_cutting_planes.size());
+        if (m_run_progress != nullptr)
+            m_run_progress->planes_done.store(i, std::memory_order_relaxed);
+
+        auto const plane_start = record_costs ? clock::now() : clock::time_point();
+
+        //* the box of the polytope takes the place of the k-dop here
+        if (m_options.use_bb_culling && ipg::classify(m_small_polytope.bounds(), m_cutting_planes[i]) < 0)
+        {
+            m_benchmark_data.culled_planes++;
+            record_outcome(i, plane_outcome::culled, plane_start);
+            continue;
+        }
+
+        auto const result = m_small_polytope.cut(m_cutting_planes[i], int(i));
+
+        if (result == SmallPolytope::cut_result::failed)
+        {
+            LOGD(Default, Debug, "degenerate cut on the small input path, using the full engine");
+            m_plane_costs.clear();
+            m_benchmark_data.culled_planes = 0;
+            for (auto& o : m_cut_log.outcomes)
+                o = plane_outcome::not_processed;
+            return false;
+        }
+
+        record_outcome(i, result == SmallPolytope::cut_result::redundant ? plane_outcome::redundant : plane_outcome::cut, plane_start);
+
+        if (result == SmallPolytope::cut_result::empty)
+        {
+            m_has_kernel = false;
+            m_certificate_pending = true; // no exact LP runs on this path, infeasibility_certificate() solves it
+            return true;
+        }
+    }
+
+    //* convert to the halfedge mesh
+    std::vector<pm::vertex_handle> vertex_of(m_small_polytope.vertex_count(), pm::vertex_handle::invalid);
+    std::vector<pm::vertex_handle> face_vertices;
+    for (auto const& f : m_small_polytope.faces())
+    {
+        face_vertices.clear();
+        for (auto i = 0; i < f.corner_count; ++i)
+        {
+            auto const v = m_small_polytope.corner_vertex(f, i);
+            if (!vertex_of[v].is_valid())
+            {
+                vertex_of[v] = m_mesh.vertices().add();
+                m_position_point4[vertex_of[v]] = m_small_polytope.vertex(v);
+            }
+            face_vertices.push_back(vertex_of[v]);
+        }
+
+        auto const face = m_mesh.faces().add(face_vertices.data(), face_vertices.size());
+        auto const source = m_small_polytope.plane_source(f.plane);
+        m_supporting_plane[face] = m_small_polytope.plane(f.plane);
+        m_input_face[face] = source >= 0 ? m_face_of_plane[source] : pm::face_handle::invalid;
+    }
+
+    m_has_kernel = !m_mesh.faces().empty();
+    return true;
 }
 
 //* cuts the given mesh with the given plane, mesh is modified and a vertex_attribute<ipg::point4> is return containing the new positions
@@ -1167,22 +1783,75 @@ void KernelPlaneCut::compute_mesh_kernel()
     // TRACE();
     LOGD(Default, Debug, "cutting plane size %s", m_cutting_planes.size());
 
-    TRACE("cutting-all-planes");
-    TRACE_BEGIN("cutting-concave-planes");
+    MK_HOT_TRACE("cutting-all-planes");
+    MK_HOT_TRACE_BEGIN("cutting-concave-planes");
     auto trace_finished = false;
 
+    //* per-plane costs (only measured on request, reading the clock twice per plane is not free for cheap planes)
+    using clock = std::chrono::steady_clock;
+    auto const record_costs = m_options.record_plane_costs;
+    auto plane_start = clock::time_point();
+    if (record_costs)
+    {
+        m_plane_costs.reserve(m_cutting_planes.size());
+        for (auto const f : m_face_of_plane)
+            m_plane_costs.push_back({int(f.idx.value), 0.0f, plane_outcome::not_processed});
+    }
+    auto const record_log = m_options.record_cut_log;
+    auto const record_outcome = [&](size_t i, plane_outcome outcome)
+    {
+        m_recent_cuts.push({int(i), outcome, int(m_mesh.vertices().size()), int(m_mesh.faces().size())});
+        if (record_log)
+            m_cut_log.outcomes[i] = outcome;
+        if (!record_costs)
+            return;
+        m_plane_costs[i].seconds = std::chrono::duration<float>(clock::now() - plane_start).count();
+        m_plane_costs[i].outcome = outcome;
+    };
+
+    //* the plane cuts off everything that is left, the certificate is only computed if asked for
+    auto const record_empty_kernel = [&](size_t i)
+    {
+        record_outcome(i, plane_outcome::cut);
+        m_has_kernel = false;
+        m_certificate_pending = true;
+    };
+
+    //* volume of the initial box, updated by every cut
+    m_track_volume = m_options.min_kernel_volume > 0;
+    if (m_track_volume)
+    {
+        auto const m = measure_polytope(m_mesh, [&](pm::vertex_handle v) { return m_position_dpos[v]; });
+        m_volume = m.volume;
+        m_area = m.area;
+        m_volume_error = volume_tolerance * m.abs_volume;
+    }
+
     for (size_t i = 0; i < m_cutting_planes.size(); i++)
     {
-        if (is_infeasible())
+        if (should_stop())
+            return;
+
+        if (record_costs)
+            plane_start = clock::now();
+
+        if (m_progress_callback)
+            m_progress_callback(i, m_cutting_planes.size());
+        if (m_run_progress != nullptr)
+            m_run_progress->planes_done.store(i, std::memory_order_relaxed);
+
+        if (is_infeasible() || int(i) == m_replay_lp_early_out_plane)
         {
             m_benchmark_data.lp_early_out = true;
+            if (record_log)
+                m_cut_log.lp_early_out_plane = int(i);
             m_has_kernel = false;
             return;
         }
 
         if (i == m_number_concave_planes)
         {
-            TRACE_END();
+            MK_HOT_TRACE_END();
             trace_finished = true;
         }
 
@@ -1190,9 +1859,13 @@ void KernelPlaneCut::compute_mesh_kernel()
         m_cutting_plane_original_face = m_face_of_plane[i];
 
         if (m_options.use_bb_culling && /*i > m_number_concave_planes &&*/ !intersects_bounding_volume())
+        {
+            m_benchmark_data.culled_planes++;
+            record_outcome(i, plane_outcome::culled);
             continue;
+        }
 
-        LOGD(Default, Debug, "cutting plane %s/%s", i, m_cutting_planes.size());
+        MK_HOT_LOG_DEBUG("cutting plane %s/%s", i, m_cutting_planes.size());
 
         //* find halfedge that gets intersected by cutting plane
         auto const start_vertex = m_mesh.vertices().last();
@@ -1201,18 +1874,37 @@ void KernelPlaneCut::compute_mesh_kernel()
         if (start_halfedge == pm::halfedge_handle::invalid) // no halfedge crossing the boundary
         {
             if (classify(start_vertex, m_cutting_plane) < 0)
+            {
+                record_outcome(i, plane_outcome::redundant);
                 continue; // entire poly inside
+            }
 
             if (!m_c0_vertex.is_valid())
             {
                 //* if the plane does not intersect but the vertex is on the positive site the kernel is empty
-                m_has_kernel = false;
+                record_empty_kernel(i);
                 return;
             }
         }
-        else
+        else if (!marching(start_halfedge))
         {
-            marching(start_halfedge);
+            m_recent_cuts.dump("marching did not close, clipping with a full scan");
+            m_benchmark_data.marching_fallbacks++;
+            auto const clip = clip_full_scan();
+            if (clip == clip_result::empty)
+            {
+                record_empty_kernel(i);
+                return;
+            }
+            if (clip == clip_result::failed)
+            {
+                //* a partial cap would leave a half-cut mesh: stop with the mesh split but otherwise unchanged
+                LOGD(Default, Error, "could not clip plane %s/%s, the run has no valid kernel", i, m_cutting_planes.size());
+                m_exact_seidel_solver.stop();
+                m_benchmark_data.clip_failed = true;
+                m_has_kernel = false;
+                return;
+            }
         }
 
         auto const proper_cut = delete_c1_vertices();
@@ -1227,9 +1919,35 @@ void KernelPlaneCut::compute_mesh_kernel()
         m_c0_vertices.clear();
         m_visited_c1_vertex.clear();
         m_c0_vertex = pm::vertex_handle::invalid;
+
+        record_outcome(i, proper_cut ? plane_outcome::cut : plane_outcome::redundant);
+
+        // cuts only shrink the polytope: once its volume is below the threshold the kernel is too small
+        // the running volume is only an estimate, the decision uses the exact positions like finalize
+        if (m_track_volume && proper_cut)
+        {
+            m_is_cap_face.clear();
+            if (tg::abs(m_volume) + m_volume_error < m_options.min_kernel_volume)
+            {
+                auto const m = measure_polytope(m_mesh, [&](pm::vertex_handle v) { return ipg::to_dpos3(m_position_point4[v]); });
+                if (tg::abs(m.volume) < m_options.min_kernel_volume)
+                {
+                    LOGD(Default, Debug, "volume below the minimum after plane %s/%s", i, m_cutting_planes.size());
+                    m_exact_seidel_solver.stop();
+                    report_kernel_volume(tg::abs(m.volume), m.area);
+                    m_has_kernel = false;
+                    return;
+                }
+
+                //* the estimate drifted, continue from the measured values
+                m_volume = m.volume;
+                m_area = m.area;
+                m_volume_error = volume_tolerance * m.abs_volume;
+            }
+        }
     }
     if (!trace_finished)
-        TRACE_END();
+        MK_HOT_TRACE_END();
 
     m_exact_seidel_solver.stop(); // cancel the LP solver if still running
 
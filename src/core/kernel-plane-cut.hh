@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <future>
 
 // system
@@ -11,6 +13,7 @@
 #include <polymesh/Mesh.hh>
 #include <polymesh/attributes/fast_clear_attribute.hh>
 
+#include <integer-plane-geometry/classify_batch.hh>
 #include <integer-plane-geometry/geometry.hh>
 #include <integer-plane-geometry/integer_math.hh>
 #include <integer-plane-geometry/plane.hh>
@@ -23,20 +26,27 @@
 // internal
 #include <core/ExactSeidelSolverPoint.hh>
 #include <core/benchmark_data.hh>
+#include <core/cut-log.hh>
 #include <core/kdop.hh>
+#include <core/kernel-planes.hh>
 #include <core/options.hh>
+#include <core/run-progress.hh>
+#include <core/small-polytope.hh>
 
 namespace mk
 {
 class KernelPlaneCut
 {
 public: // types
+    struct result_view;
+
     using geometry_t = ipg::geometry<26, 55>;
     using pos_t = typename geometry_t::pos_t;
     using vec_t = typename geometry_t::vec_t;
     using point4_t = typename geometry_t::point4_t;
     using plane_t = typename geometry_t::plane_t;
     using line_t = typename ipg::line<geometry_t>;
+    using aabb_t = typename geometry_t::aabb_t;
 
 public: // API
     KernelPlaneCut() = default;
@@ -45,6 +55,12 @@ public: // API
 
     void compute_kernel(pm::vertex_attribute<pos_t> const& input_positions, kernel_options const& options = {});
 
+    /// runs only the cutting phase on the planes of a recorded log: no input mesh, no plane setup, no exact LP thread
+    /// (its early out happens at the recorded plane), deterministic for a given log
+    /// input_face() and the certificate refer to no input mesh and are invalid
+    /// with record_log, recorded_cut_log() holds the outcomes of the replay (to compare them against the log)
+    void replay(cut_log const& log, bool record_log = false);
+
     bool has_kernel() const { return m_has_kernel; }
 
     bool input_is_convex() const { return m_input_is_convex; }
@@ -53,12 +69,72 @@ public: // API
 
     pm::vertex_attribute<point4_t> const& position_point4() const { return m_position_point4; }
 
+    /// the kernel of the last compute_kernel without copying it, see result_view
+    result_view result() const;
+
+    /// copies the topology of the (non-convex) result into mesh and writes its vertices divided by upscale_factor into position
+    /// the exact to double conversion and the rescaling are a single pass, position is rebound to mesh
+    void copy_result(pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position, double upscale_factor) const;
+
+    /// distinct supporting planes of the kernel faces (the input face planes for convex inputs), empty if there is no kernel
+    /// no vertex is converted, the planes are exact
+    cc::vector<kernel_plane> kernel_planes() const;
+
     mk::benchmark_data const& stats() const { return m_benchmark_data; }
 
+    /// one entry per cutting plane in cutting order, empty unless kernel_options::record_plane_costs is set
+    cc::vector<plane_cost> const& plane_costs() const { return m_plane_costs; }
+
+    /// unique planes of the non-convex input in cutting order (empty for convex inputs), the kernel is their negative side
+    cc::vector<plane_t> const& cutting_planes() const { return m_cutting_planes; }
+
+    /// input faces (at most four) whose planes alone already have an empty kernel, see certificate.hh
+    /// only set if the last compute_kernel found an empty kernel (by the clipper or the exact LP), empty otherwise
+    /// if the clipper found it first, the first call waits for the exact LP (or solves it if it did not run)
+    cc::vector<pm::face_handle> const& infeasibility_certificate() const;
+
+    /// planes and decisions of the last compute_kernel, empty unless kernel_options::record_cut_log is set
+    cut_log const& recorded_cut_log() const { return m_cut_log; }
+
+    /// the last RecentCuts::capacity planes of the clipper (always recorded, dumped when marching fails)
+    RecentCuts const& recent_cuts() const { return m_recent_cuts; }
+
+    /// maps each face of mesh() to the input face generating it
+    pm::face_attribute<pm::face_handle> const& input_face() const { return m_input_face; }
+
+    /// compute_kernel returns early without a kernel once *stop becomes true (also stops the parallel exact LP)
+    /// the flag must outlive the computation, nullptr disables the check
+    void set_stop_token(std::atomic<bool> const* stop) { m_stop = stop; }
+
+    /// true if the last compute_kernel was ended by the stop token
+    bool was_cancelled() const { return m_was_cancelled; }
+
+    /// called before each cutting plane with (processed planes, total planes)
+    /// mesh() and position_point4() hold the intermediate polytope during the call
+    void set_progress_callback(std::function<void(size_t, size_t)> callback) { m_progress_callback = std::move(callback); }
+
+    /// phase, plane count and LP state are stored into *progress while computing (relaxed atomics, one store per plane)
+    /// the progress must outlive the computation, nullptr disables it
+    void set_run_progress(run_progress* progress) { m_run_progress = progress; }
+
+public: // types
+    /// references into the KernelPlaneCut (or the input), valid until the next compute_kernel
+    struct result_view
+    {
+        bool is_empty = true;
+        bool is_input = false; // convex input: the kernel is the input mesh itself, nothing was clipped
+        pm::Mesh const* mesh = nullptr;
+        pm::vertex_attribute<point4_t> const* points = nullptr;      // exact vertices of the clipped polytope, nullptr if is_input
+        pm::vertex_attribute<pos_t> const* input_positions = nullptr; // positions of the input, is_input only
+    };
+
 private: // member
     /// settings
     kernel_options m_options;
 
+    /// input of the last compute_kernel, only used by result() for convex inputs
+    pm::vertex_attribute<pos_t> const* m_input_positions = nullptr;
+
     /// planes of the input mesh
     pm::face_attribute<plane_t> m_input_plane;
 
@@ -110,16 +186,46 @@ private: // member
     pm::fast_clear_attribute<bool, pm::vertex_tag> m_visited_c1_vertex = pm::make_fast_clear_attribute(m_mesh.vertices(), false);
     pm::vertex_handle m_c0_vertex;
 
+    /// running volume and surface area of the polytope, only tracked if kernel_options::min_kernel_volume > 0
+    /// the volume is signed by the face orientation, each proper cut subtracts the volume of its cap
+    bool m_track_volume = false;
+    double m_volume = 0.0;
+    double m_area = 0.0;
+    double m_volume_error = 0.0; // estimated drift of m_volume, below the threshold the volume is measured exactly
+    pm::fast_clear_attribute<bool, pm::face_tag> m_is_cap_face = pm::make_fast_clear_attribute(m_mesh.faces(), false);
+
+    /// vertices of the polytope for the lane-parallel classification of clip_full_scan, kept for their storage
+    cc::vector<point4_t> m_batch_points;
+    ipg::point4_batch<geometry_t> m_vertex_batch; // limb layout of m_batch_points for the simd classification
+
+    /// clipper of the small input path, kept for its storage
+    SmallPolytope m_small_polytope;
+
     /// exact seidel solver for early out check
     ExactSeidelSolverPoint m_exact_seidel_solver;
-    std::future<ExactSeidelSolverPoint::state> m_exact_seidel_solver_result;
+    mutable std::future<ExactSeidelSolverPoint::state> m_exact_seidel_solver_result;
     bool m_has_queried_future = false; // avoid query more than once
     bool m_is_infeasible = false;
 
     bool m_has_kernel = false;
     std::atomic<bool> m_input_is_convex = true;
 
+    mutable cc::vector<pm::face_handle> m_certificate;
+    mutable bool m_certificate_pending = false; // the clipper found the kernel empty, the subset is taken from the exact LP on request
+
     benchmark_data m_benchmark_data;
+    cc::vector<plane_cost> m_plane_costs;
+
+    /// record and replay of the cutting phase
+    cut_log m_cut_log;
+    RecentCuts m_recent_cuts;
+    int m_replay_lp_early_out_plane = -1;
+
+    /// cancellation and progress reporting
+    std::atomic<bool> const* m_stop = nullptr;
+    bool m_was_cancelled = false;
+    std::function<void(size_t, size_t)> m_progress_callback;
+    run_progress* m_run_progress = nullptr;
 
     //* debug only
     bool m_debug = false;
@@ -127,27 +233,60 @@ private: // member
 
 private: // helper
     void reset();
+    /// checks the stop token, stops the exact LP if set
+    bool should_stop();
+    /// publishes m_benchmark_data and the new phase to m_run_progress
+    void report_phase(run_phase phase);
     bool has_trivial_solution();
     void init_point4_position(pm::vertex_attribute<pos_t> const& positions);
     void init_cutting_planes_flood_fill(pm::vertex_attribute<pos_t> const& positions);
     void init_input_planes(pm::vertex_attribute<pos_t> const& positions);
     void init_edge_state(pm::vertex_attribute<pos_t> const& positions);
-    void init_with_aabb(pm::vertex_attribute<pos_t> const& input_position, pm::Mesh& mesh, pm::vertex_attribute<pos_t>& output_position);
+    void init_with_aabb(aabb_t const& aabb, pm::Mesh& mesh, pm::vertex_attribute<pos_t>& output_position);
     void classify_vertices(plane_t const& cutting_plane);
     void init_cutting_planes_uset(pm::vertex_attribute<pos_t> const& positions);
 
     /// returns true, if the exact seidel solver has finished and determided that the kernel is empty
     bool is_infeasible();
 
+    /// maps an infeasible subset of m_cutting_planes to m_certificate
+    void set_certificate(cc::span<int const> plane_indices) const;
+
     void compute_mesh_kernel();
+
+    /// sets the kernel_* stats from the volume and surface area of the kernel
+    void report_kernel_volume(double volume, double area);
+
+    /// cuts all planes with m_small_polytope (no exact LP thread, no supporting structure)
+    /// returns false if a degenerate cut failed, the full engine has to be used then
+    bool compute_small_mesh_kernel(aabb_t const& aabb);
+
     bool is_convex();
     bool kernel_is_empty();
     void set_edge_lines(pm::vertex_attribute<pos_t> const& positions);
     void init_supporting_structure(pm::vertex_attribute<pos_t> const& position);
+    void init_supporting_structure(aabb_t const& aabb);
+
+    /// starts m_cut_log with the options, the box and the cutting planes
+    void begin_cut_log(aabb_t const& aabb);
 
     pm::halfedge_handle edge_descent(pm::vertex_handle const& start_vertex);
     pm::halfedge_handle edge_descent_exact(pm::vertex_handle const& vertex);
-    void marching(pm::halfedge_handle const& start_halfedge);
+    /// returns false if the march did not close within a bound tied to the halfedge count (degenerate configuration)
+    /// the mesh is then split along the plane only partially, clip_full_scan finishes the cut
+    bool marching(pm::halfedge_handle const& start_halfedge);
+
+    enum class clip_result
+    {
+        cut,       // m_c0_vertices holds the closed cap loop
+        redundant, // no vertex on the positive side
+        empty,     // no vertex on the negative side, nothing is left of the kernel
+        failed,    // no closed cap loop was found, the mesh must not be edited further
+    };
+
+    /// splits all crossing edges and faces of m_cutting_plane and collects the cap loop into m_c0_vertices
+    /// visits every vertex, edge and face: only used when marching fails
+    clip_result clip_full_scan();
     bool delete_c1_vertices();
     void fill_cut_hole();
 
@@ -0,0 +1,90 @@
+#include "kernel-planes.hh"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+constexpr char kernel_planes_magic[8] = {'M', 'K', 'P', 'L', 'N', 'S', '0', '1'};
+
+using plane_t = mk::kernel_plane::plane_t;
+
+static_assert(sizeof(plane_t::normal_scalar_t) == 8, "normals are stored as i64");
+static_assert(sizeof(plane_t::distance_t) == 16, "distances are stored as i128");
+
+/// a, b, c, d, input face
+constexpr size_t plane_record_bytes = 3 * 8 + 16 + 4;
+
+template <class T>
+void write_value(std::ofstream& out, T const& v)
+{
+    out.write(reinterpret_cast<char const*>(&v), sizeof(T));
+}
+
+template <class T>
+bool read_value(std::ifstream& in, T& v)
+{
+    return bool(in.read(reinterpret_cast<char*>(&v), sizeof(T)));
+}
+}
+
+bool mk::save_kernel_planes(std::string const& path, cc::span<kernel_plane const> planes, int input_face_count, double upscale_factor)
+{
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+        return false;
+
+    out.write(kernel_planes_magic, sizeof(kernel_planes_magic));
+    write_value(out, uint32_t(input_face_count));
+    write_value(out, uint32_t(planes.size()));
+    write_value(out, upscale_factor);
+
+    for (auto const& p : planes)
+    {
+        write_value(out, p.plane.a);
+        write_value(out, p.plane.b);
+        write_value(out, p.plane.c);
+        write_value(out, p.plane.d);
+        write_value(out, int32_t(p.input_face));
+    }
+    return bool(out);
+}
+
+bool mk::load_kernel_planes(std::string const& path, cc::vector<kernel_plane>& planes, int& input_face_count, double& upscale_factor)
+{
+    planes.clear();
+
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(kernel_planes_magic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kernel_planes_magic, sizeof(magic)) != 0)
+        return false;
+
+    uint32_t face_count = 0;
+    uint32_t plane_count = 0;
+    if (!read_value(in, face_count) || !read_value(in, plane_count) || !read_value(in, upscale_factor))
+        return false;
+    input_face_count = int(face_count);
+
+    // the count of a truncated or corrupt file must not decide the allocation
+    auto const header_end = in.tellg();
+    in.seekg(0, std::ios::end);
+    auto const remaining = size_t(in.tellg() - header_end);
+    in.seekg(header_end);
+    if (!in || remaining < size_t(plane_count) * plane_record_bytes)
+        return false;
+
+    planes.reserve(plane_count);
+    for (auto i = 0u; i < plane_count; ++i)
+    {
+        kernel_plane p;
+        int32_t input_face = -1;
+        if (!read_value(in, p.plane.a) || !read_value(in, p.plane.b) || !read_value(in, p.plane.c) || !read_value(in, p.plane.d) || !read_value(in, input_face))
+            return false;
+        if (input_face >= int32_t(face_count))
+            return false;
+
+        p.input_face = input_face;
+        planes.push_back(p);
+    }
+    return true;
+}
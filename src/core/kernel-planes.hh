@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+#include <clean-core/span.hh>
+#include <clean-core/vector.hh>
+
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+
+namespace mk
+{
+/// one bounding plane of the kernel (its H-representation), see KernelPlaneCut::kernel_planes
+struct kernel_plane
+{
+    using geometry_t = ipg::geometry<26, 55>;
+    using plane_t = typename geometry_t::plane_t;
+
+    plane_t plane; // exact, oriented like the supporting planes of KernelPlaneCut, in the quantized input coordinates
+    int input_face = -1; // input face generating the plane, -1 for planes of the initial bounding volume
+};
+
+/// binary file, little endian:
+///   "MKPLNS01", u32 input face count, u32 plane count, f64 upscale factor (quantized = normalized * upscale factor),
+///   per plane: 3 x i64 normal, 16 byte i128 distance (two's complement), i32 input face
+bool save_kernel_planes(std::string const& path, cc::span<kernel_plane const> planes, int input_face_count, double upscale_factor);
+
+/// returns false if the file does not exist or is not a plane file
+bool load_kernel_planes(std::string const& path, cc::vector<kernel_plane>& planes, int& input_face_count, double& upscale_factor);
+}
@@ -0,0 +1,308 @@
+#include "kernel-sampler.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <typed-geometry/tg.hh>
+
+#if defined(MK_TBB_ENABLED)
+#include <tbb/tbb.h>
+#endif
+
+// internal
+#include <core/ExactSeidelSolverPoint.hh>
+
+namespace
+{
+/// samples per random stream of the tetrahedron sampler
+constexpr size_t batch_size = 4096;
+
+/// independent streams for every batch: the result does not depend on the number of threads
+std::mt19937_64 make_stream(uint64_t seed, uint64_t batch)
+{
+    // splitmix64 of the combined seed so that neighbouring batches get unrelated states
+    auto z = seed + 0x9E3779B97F4A7C15ull * (batch + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return std::mt19937_64(z ^ (z >> 31));
+}
+
+/// uniform in [0, 1)
+double uniform01(std::mt19937_64& rng) { return double(rng() >> 11) * 0x1.0p-53; }
+
+/// calls f(batch_index) for every batch, in parallel if available
+template <class F>
+void for_each_batch(size_t batch_count, F&& f)
+{
+#if defined(MK_TBB_ENABLED)
+    if (batch_count > 1)
+    {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, batch_count),
+                          [&](tbb::blocked_range<size_t> const& range)
+                          {
+                              for (auto i = range.begin(); i < range.end(); ++i)
+                                  f(i);
+                          });
+        return;
+    }
+#endif
+    for (size_t i = 0; i < batch_count; ++i)
+        f(i);
+}
+}
+
+bool mk::KernelSampler::build(pm::vertex_attribute<point4_t> const& position)
+{
+    return build(position.map([](point4_t const& p) { return ipg::to_dpos3(p); }));
+}
+
+bool mk::KernelSampler::build(pm::vertex_attribute<tg::dpos3> const& position)
+{
+    auto const& mesh = position.mesh();
+    m_tetrahedra.clear();
+    m_probability.clear();
+    m_alias.clear();
+    m_volume = 0.0;
+
+    if (mesh.vertices().empty())
+        return false;
+
+    //* fan tetrahedralization: every face not incident to the apex forms a fan of tetrahedra with it
+    auto const apex_vertex = mesh.vertices().first();
+    auto const apex = position[apex_vertex];
+
+    std::vector<double> volumes;
+    for (auto const f : mesh.faces())
+    {
+        if (f.vertices().any([&](pm::vertex_handle v) { return v == apex_vertex; }))
+            continue;
+
+        auto const he0 = f.any_halfedge();
+        auto const p0 = position[he0.vertex_from()];
+        for (auto he = he0.next(); he.vertex_to() != he0.vertex_from(); he = he.next())
+        {
+            auto const t = tetrahedron{apex, p0 - apex, position[he.vertex_from()] - apex, position[he.vertex_to()] - apex};
+            auto const volume = tg::abs(tg::dot(t.ab, tg::cross(t.ac, t.ad))) / 6.0;
+            if (volume <= 0.0)
+                continue;
+
+            m_tetrahedra.push_back(t);
+            volumes.push_back(volume);
+            m_volume += volume;
+        }
+    }
+
+    if (m_tetrahedra.empty() || !(m_volume > 0.0))
+    {
+        m_tetrahedra.clear();
+        return false;
+    }
+
+    //* alias table (Vose)
+    auto const n = int(m_tetrahedra.size());
+    m_probability.resize(n);
+    m_alias.resize(n);
+
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (auto i = 0; i < n; ++i)
+    {
+        scaled[i] = volumes[i] * n / m_volume;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        auto const s = small.back();
+        small.pop_back();
+        auto const l = large.back();
+
+        m_probability[s] = scaled[s];
+        m_alias[s] = l;
+
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        if (scaled[l] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // leftovers are 1 up to rounding
+    for (auto const i : large)
+    {
+        m_probability[i] = 1.0;
+        m_alias[i] = i;
+    }
+    for (auto const i : small)
+    {
+        m_probability[i] = 1.0;
+        m_alias[i] = i;
+    }
+
+    return true;
+}
+
+std::vector<tg::dpos3> mk::KernelSampler::sample(size_t count, uint64_t seed) const
+{
+    if (m_tetrahedra.empty())
+        return {};
+
+    std::vector<tg::dpos3> samples(count);
+    auto const batch_count = (count + batch_size - 1) / batch_size;
+
+    for_each_batch(batch_count,
+                   [&](size_t batch)
+                   {
+                       auto rng = make_stream(seed, batch);
+                       auto const end = std::min(count, (batch + 1) * batch_size);
+                       for (auto i = batch * batch_size; i < end; ++i)
+                       {
+                           //* pick a tetrahedron proportional to its volume
+                           auto const column = std::min(int(uniform01(rng) * m_tetrahedra.size()), int(m_tetrahedra.size()) - 1);
+                           auto const& t = m_tetrahedra[uniform01(rng) < m_probability[column] ? column : m_alias[column]];
+
+                           //* uniform point in the tetrahedron by folding the unit cube (Rocchini and Cignoni)
+                           auto s = uniform01(rng);
+                           auto u = uniform01(rng);
+                           auto v = uniform01(rng);
+                           if (s + u > 1.0)
+                           {
+                               s = 1.0 - s;
+                               u = 1.0 - u;
+                           }
+                           if (u + v > 1.0)
+                           {
+                               auto const tmp = v;
+                               v = 1.0 - s - u;
+                               u = 1.0 - tmp;
+                           }
+                           else if (s + u + v > 1.0)
+                           {
+                               auto const tmp = v;
+                               v = s + u + v - 1.0;
+                               s = 1.0 - u - tmp;
+                           }
+
+                           samples[i] = t.a + s * t.ab + u * t.ac + v * t.ad;
+                       }
+                   });
+
+    return samples;
+}
+
+bool mk::HitAndRunSampler::build(cc::span<plane_t const> planes)
+{
+    m_is_valid = false;
+
+    ExactSeidelSolverPoint solver;
+    solver.set_planes(planes);
+    if (solver.solve() == ExactSeidelSolverPoint::state::infeasible)
+        return false;
+
+    auto const& solution = solver.get_solution();
+    if (!solution.is_point())
+        return false; // unbounded
+
+    return build(planes, ipg::to_dpos3(solution.position));
+}
+
+bool mk::HitAndRunSampler::build(cc::span<plane_t const> planes, tg::dpos3 start)
+{
+    m_is_valid = false;
+    m_halfspaces.clear();
+    m_halfspaces.reserve(planes.size());
+
+    for (auto const& p : planes)
+    {
+        auto const n = tg::dvec3(double(p.a), double(p.b), double(p.c));
+        auto const length = tg::length(n);
+        if (length == 0.0)
+            continue;
+        m_halfspaces.push_back({n / length, double(p.d) / length});
+    }
+
+    if (m_halfspaces.empty())
+        return false;
+
+    m_start = start;
+
+    // a chord that leaves along an axis means the polytope is unbounded
+    for (auto axis = 0; axis < 3; ++axis)
+        for (auto const sign : {-1.0, 1.0})
+        {
+            auto dir = tg::dvec3::zero;
+            dir[axis] = sign;
+            auto blocked = false;
+            for (auto const& h : m_halfspaces)
+                blocked |= tg::dot(h.normal, dir) > 0.0;
+            if (!blocked)
+                return false;
+        }
+
+    m_is_valid = true;
+    return true;
+}
+
+std::vector<tg::dpos3> mk::HitAndRunSampler::sample(size_t count, uint64_t seed, hit_and_run_settings const& settings) const
+{
+    if (!m_is_valid || count == 0)
+        return {};
+
+    auto const chain_length = size_t(std::max(1, settings.chain_length));
+    auto const chain_count = (count + chain_length - 1) / chain_length;
+    std::vector<tg::dpos3> samples(count);
+
+    for_each_batch(chain_count,
+                   [&](size_t chain)
+                   {
+                       auto rng = make_stream(seed, chain);
+                       std::normal_distribution<double> gaussian;
+                       auto x = m_start;
+
+                       // moves x to a uniform point on the chord through x in a random direction
+                       auto const step = [&]
+                       {
+                           // the start point may be a vertex: retry until the direction points inside
+                           for (auto attempt = 0; attempt < 64; ++attempt)
+                           {
+                               auto const d = tg::normalize_safe(tg::dvec3(gaussian(rng), gaussian(rng), gaussian(rng)));
+                               if (d == tg::dvec3::zero)
+                                   continue;
+
+                               auto t_min = -std::numeric_limits<double>::infinity();
+                               auto t_max = std::numeric_limits<double>::infinity();
+                               for (auto const& h : m_halfspaces)
+                               {
+                                   auto const slack = std::max(0.0, -(tg::dot(h.normal, tg::dvec3(x)) + h.offset));
+                                   auto const nd = tg::dot(h.normal, d);
+                                   if (nd > 0.0)
+                                       t_max = std::min(t_max, slack / nd);
+                                   else if (nd < 0.0)
+                                       t_min = std::max(t_min, slack / nd);
+                               }
+
+                               if (!std::isfinite(t_min) || !std::isfinite(t_max) || !(t_max > t_min))
+                                   continue;
+
+                               x = x + (t_min + uniform01(rng) * (t_max - t_min)) * d;
+                               return;
+                           }
+                       };
+
+                       for (auto i = 0; i < settings.burn_in; ++i)
+                           step();
+
+                       auto const end = std::min(count, (chain + 1) * chain_length);
+                       for (auto i = chain * chain_length; i < end; ++i)
+                       {
+                           for (auto k = 0; k < std::max(1, settings.thinning); ++k)
+                               step();
+                           samples[i] = x;
+                       }
+                   });
+
+    return samples;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <clean-core/span.hh>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+#include <integer-plane-geometry/point.hh>
+
+namespace mk
+{
+/// uniform random points inside a finished convex polytope (e.g. the kernel)
+/// the polytope is split into a fan of tetrahedra around one vertex, a tetrahedron is chosen by volume (alias table)
+/// and a point is drawn uniformly inside it
+/// samples are generated in fixed-size batches with one random stream per batch, so the result only depends on the seed
+class KernelSampler
+{
+public: // types
+    using geometry_t = ipg::geometry<26, 55>;
+    using point4_t = typename geometry_t::point4_t;
+
+public: // API
+    /// builds the tetrahedra and the alias table, returns false if the polytope has no volume
+    bool build(pm::vertex_attribute<tg::dpos3> const& position);
+
+    /// same as above for exact homogeneous positions (KernelPlaneCut::position_point4), every vertex is converted to double once
+    bool build(pm::vertex_attribute<point4_t> const& position);
+
+    /// count uniform samples (in parallel if tbb is enabled), empty if build failed
+    std::vector<tg::dpos3> sample(size_t count, uint64_t seed = 0) const;
+
+    double volume() const { return m_volume; }
+
+    size_t tetrahedron_count() const { return m_tetrahedra.size(); }
+
+private:
+    struct tetrahedron
+    {
+        tg::dpos3 a;
+        tg::dvec3 ab, ac, ad;
+    };
+
+    std::vector<tetrahedron> m_tetrahedra;
+
+    /// Vose's alias table: tetrahedron i is taken with probability m_probability[i], otherwise m_alias[i]
+    std::vector<double> m_probability;
+    std::vector<int> m_alias;
+
+    double m_volume = 0.0;
+};
+
+struct hit_and_run_settings
+{
+    /// steps discarded at the start of every chain
+    int burn_in = 200;
+
+    /// steps between two returned samples, larger values give less correlated samples
+    int thinning = 10;
+
+    /// samples per chain, chains run in parallel
+    int chain_length = 1024;
+};
+
+/// hit-and-run random walk directly on the half-spaces a*x + b*y + c*z + d <= 0 of the cutting planes
+/// (no polytope is built, the samples are asymptotically uniform)
+/// the start point is the vertex found by the exact Seidel solver, coordinates are the ones of the planes
+class HitAndRunSampler
+{
+public: // types
+    using geometry_t = ipg::geometry<26, 55>;
+    using plane_t = typename geometry_t::plane_t;
+
+public: // API
+    /// converts the planes to double and finds a start point, returns false if the intersection is empty or unbounded
+    bool build(cc::span<plane_t const> planes);
+
+    /// same as above with a known start point inside (or on the boundary of) the polytope
+    bool build(cc::span<plane_t const> planes, tg::dpos3 start);
+
+    /// count samples from independent chains (in parallel if tbb is enabled), empty if build failed
+    std::vector<tg::dpos3> sample(size_t count, uint64_t seed = 0, hit_and_run_settings const& settings = {}) const;
+
+private:
+    struct halfspace
+    {
+        tg::dvec3 normal; // unit length
+        double offset;    // signed distance of the origin, inside: dot(normal, p) + offset <= 0
+    };
+
+    std::vector<halfspace> m_halfspaces;
+    tg::dpos3 m_start;
+    bool m_is_valid = false;
+};
+}
@@ -0,0 +1,105 @@
+#include "mesh-cache.hh"
+
+namespace
+{
+/// topology of pm::Mesh: one index per vertex and face, four per halfedge (plus the removed flags)
+size_t topology_bytes(pm::Mesh const& m)
+{
+    return m.all_vertices().size() * sizeof(int) + m.all_faces().size() * sizeof(int) + m.all_halfedges().size() * 4 * sizeof(int);
+}
+}
+
+size_t mk::estimate_bytes(cached_mesh const& entry)
+{
+    auto bytes = sizeof(cached_mesh);
+    if (entry.input)
+    {
+        auto const& m = entry.input->mesh;
+        bytes += topology_bytes(m) + m.all_vertices().size() * (sizeof(tg::dpos3) + sizeof(tg::ipos3));
+    }
+    if (entry.kernel)
+    {
+        auto const& m = entry.kernel->mesh;
+        bytes += topology_bytes(m) + m.all_vertices().size() * sizeof(tg::dpos3);
+        bytes += entry.kernel->plane_costs.size() * sizeof(plane_cost) + (entry.kernel->contributing_faces.size() + entry.kernel->certificate_faces.size()) * sizeof(int);
+    }
+    return bytes;
+}
+
+std::shared_ptr<mk::cached_mesh const> mk::MeshCache::get(std::string const& key)
+{
+    std::lock_guard lock(m_mutex);
+    auto const it = m_index.find(key);
+    if (it == m_index.end())
+        return nullptr;
+
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->entry;
+}
+
+bool mk::MeshCache::contains(std::string const& key) const
+{
+    std::lock_guard lock(m_mutex);
+    return m_index.count(key) > 0;
+}
+
+void mk::MeshCache::put(std::string const& key, std::shared_ptr<cached_mesh const> entry)
+{
+    auto const bytes = entry ? estimate_bytes(*entry) : 0;
+
+    std::lock_guard lock(m_mutex);
+    auto const it = m_index.find(key);
+    if (it != m_index.end())
+    {
+        m_bytes_used -= it->second->bytes;
+        m_lru.erase(it->second);
+        m_index.erase(it);
+    }
+
+    if (!entry)
+        return;
+
+    m_lru.push_front({key, std::move(entry), bytes});
+    m_index[key] = m_lru.begin();
+    m_bytes_used += bytes;
+    evict();
+}
+
+void mk::MeshCache::set_budget(size_t budget_bytes)
+{
+    std::lock_guard lock(m_mutex);
+    m_budget_bytes = budget_bytes;
+    evict();
+}
+
+void mk::MeshCache::clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_bytes_used = 0;
+}
+
+size_t mk::MeshCache::bytes_used() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_bytes_used;
+}
+
+size_t mk::MeshCache::size() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_lru.size();
+}
+
+void mk::MeshCache::evict()
+{
+    // keep at least the most recently used entry
+    while (m_bytes_used > m_budget_bytes && m_lru.size() > 1)
+    {
+        auto const& last = m_lru.back();
+        m_bytes_used -= last.bytes;
+        m_index.erase(last.key);
+        m_lru.pop_back();
+    }
+}
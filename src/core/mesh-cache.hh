@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+#include <polymesh/algorithms/normalize.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+// internal
+#include <core/benchmark_data.hh>
+#include <core/options.hh>
+
+namespace mk
+{
+/// profile of prepare_mesh
+struct load_stats
+{
+    double time_read_seconds = 0.0;
+    double time_quantize_seconds = 0.0; // normalization, scaling and quantization
+    double time_weld_seconds = 0.0;     // 0 for closed inputs
+    int welded_vertices = 0;            // vertices merged by welding
+    int degenerate_faces = 0;           // faces dropped by welding
+};
+
+template <class I>
+void introspect(I&& i, load_stats& s)
+{
+    i(s.time_read_seconds, "time_read_seconds");
+    i(s.time_quantize_seconds, "time_quantize_seconds");
+    i(s.time_weld_seconds, "time_weld_seconds");
+    i(s.welded_vertices, "welded_vertices");
+    i(s.degenerate_faces, "degenerate_faces");
+}
+
+/// input mesh after loading, normalization and quantization
+struct prepared_mesh
+{
+    pm::Mesh mesh;
+    pm::vertex_attribute<tg::dpos3> position{mesh};
+    pm::vertex_attribute<tg::ipos3> int_position{mesh};
+    pm::normalize_result<double> normalize_result;
+    double upscale_factor = 0.0;
+    load_stats stats;
+};
+
+/// (intermediate) kernel polytope published by the background computation, positions in normalized coordinates
+struct kernel_snapshot
+{
+    pm::Mesh mesh;
+    pm::vertex_attribute<tg::dpos3> position{mesh};
+    bool is_final = false;
+    bool is_empty = false;
+
+    /// convex inputs are their own kernel: the input is shared instead of copied into mesh and position
+    std::shared_ptr<prepared_mesh const> input_kernel;
+
+    //* profile of the computation, final snapshots only
+    benchmark_data stats;
+    std::vector<plane_cost> plane_costs; // empty unless kernel_options::record_plane_costs was set
+    std::vector<int> contributing_faces; // input faces that generated a kernel face
+    std::vector<int> certificate_faces;  // empty kernels: input faces proving it, see certificate.hh
+};
+
+/// cache entry of one file: the prepared input and optionally its final kernel
+struct cached_mesh
+{
+    std::shared_ptr<prepared_mesh const> input;
+    std::shared_ptr<kernel_snapshot const> kernel; // nullptr if not computed
+    kernel_options options;                        // options the kernel was computed with
+};
+
+/// approximate memory footprint of a cache entry in bytes
+size_t estimate_bytes(cached_mesh const& entry);
+
+/// thread-safe LRU cache of prepared meshes with a memory budget
+/// entries are immutable and shared, eviction only drops the reference of the cache
+class MeshCache
+{
+public:
+    explicit MeshCache(size_t budget_bytes = size_t(1) << 30) : m_budget_bytes(budget_bytes) {}
+
+    /// returns nullptr if not cached, marks the entry as most recently used
+    std::shared_ptr<cached_mesh const> get(std::string const& key);
+
+    bool contains(std::string const& key) const;
+
+    /// inserts or replaces the entry and evicts the least recently used ones until the budget is met
+    /// the inserted entry itself is never evicted
+    void put(std::string const& key, std::shared_ptr<cached_mesh const> entry);
+
+    void set_budget(size_t budget_bytes);
+    void clear();
+
+    size_t budget_bytes() const { return m_budget_bytes; }
+    size_t bytes_used() const;
+    size_t size() const;
+
+private:
+    void evict();
+
+private:
+    struct slot
+    {
+        std::string key;
+        std::shared_ptr<cached_mesh const> entry;
+        size_t bytes = 0;
+    };
+
+    mutable std::mutex m_mutex;
+    std::list<slot> m_lru; // front = most recently used
+    std::unordered_map<std::string, std::list<slot>::iterator> m_index;
+    size_t m_budget_bytes = 0;
+    size_t m_bytes_used = 0;
+};
+}
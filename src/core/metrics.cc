@@ -0,0 +1,301 @@
+#include "metrics.hh"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <rich-log/log.hh>
+
+namespace
+{
+template <class T>
+void add_relaxed(std::atomic<T>& counter, T value)
+{
+    // only the owning worker writes: no read-modify-write needed
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/// sum of one counter over all workers
+template <class T>
+T sum_over(std::vector<mk::worker_metrics> const& workers, std::atomic<T> mk::worker_metrics::*counter)
+{
+    T sum = 0;
+    for (auto const& w : workers)
+        sum += (w.*counter).load(std::memory_order_relaxed);
+    return sum;
+}
+
+void write_counter(std::ostream& out, char const* name, char const* help, uint64_t value)
+{
+    out << "# TYPE mesh_kernel_" << name << " counter\n";
+    out << "# HELP mesh_kernel_" << name << ' ' << help << '\n';
+    out << "mesh_kernel_" << name << "_total " << value << '\n';
+}
+
+void write_gauge(std::ostream& out, char const* name, char const* help, double value)
+{
+    out << "# TYPE mesh_kernel_" << name << " gauge\n";
+    out << "# HELP mesh_kernel_" << name << ' ' << help << '\n';
+    out << "mesh_kernel_" << name << ' ' << value << '\n';
+}
+}
+
+char const* mk::to_string(metrics_phase phase)
+{
+    switch (phase)
+    {
+    case metrics_phase::load:
+        return "load";
+    case metrics_phase::input_planes:
+        return "input_planes";
+    case metrics_phase::edge_state:
+        return "edge_state";
+    case metrics_phase::cutting_planes:
+        return "cutting_planes";
+    case metrics_phase::supporting_structure:
+        return "supporting_structure";
+    case metrics_phase::cutting:
+        return "cutting";
+    case metrics_phase::finalize:
+        return "finalize";
+    case metrics_phase::total:
+        return "total";
+    case metrics_phase::count:
+        break;
+    }
+    return "unknown";
+}
+
+void mk::worker_metrics::observe(metrics_phase phase, double seconds)
+{
+    auto& h = phases[size_t(phase)];
+
+    auto bucket = size_t(0);
+    while (bucket < bucket_bounds.size() && seconds > bucket_bounds[bucket])
+        bucket++;
+
+    add_relaxed(h.buckets[bucket], uint64_t(1));
+    add_relaxed(h.sum, seconds);
+    add_relaxed(h.count, uint64_t(1));
+}
+
+void mk::worker_metrics::add_mesh(benchmark_data const& stats, double load_seconds, bool has_kernel)
+{
+    observe(metrics_phase::load, load_seconds);
+    observe(metrics_phase::input_planes, stats.time_input_planes_seconds);
+    observe(metrics_phase::edge_state, stats.time_edge_state_seconds);
+    if (!stats.is_convex)
+    {
+        observe(metrics_phase::cutting_planes, stats.time_cutting_planes_seconds);
+        observe(metrics_phase::supporting_structure, stats.time_supporting_structure_seconds);
+        observe(metrics_phase::cutting, stats.time_cutting_seconds);
+        observe(metrics_phase::finalize, stats.time_finalize_seconds);
+    }
+    observe(metrics_phase::total, load_seconds + stats.time_total_seconds);
+
+    add_relaxed(meshes, uint64_t(1));
+    add_relaxed(convex_inputs, uint64_t(stats.is_convex));
+    add_relaxed(empty_kernels, uint64_t(!has_kernel));
+    add_relaxed(lp_early_outs, uint64_t(stats.lp_early_out));
+    add_relaxed(small_mesh_paths, uint64_t(stats.small_mesh_path));
+    add_relaxed(planes, uint64_t(stats.total_planes));
+    add_relaxed(concave_planes, uint64_t(stats.number_concave_planes));
+    add_relaxed(culled_planes, uint64_t(stats.culled_planes));
+    add_relaxed(busy_seconds, load_seconds + stats.time_total_seconds);
+}
+
+void mk::worker_metrics::add_certificate_reject(double seconds)
+{
+    add_relaxed(meshes, uint64_t(1));
+    add_relaxed(empty_kernels, uint64_t(1));
+    add_relaxed(certificate_rejects, uint64_t(1));
+    add_relaxed(busy_seconds, seconds);
+}
+
+void mk::worker_metrics::add_load_failure(double seconds)
+{
+    add_relaxed(load_failures, uint64_t(1));
+    add_relaxed(busy_seconds, seconds);
+}
+
+mk::Metrics::Metrics(int workers) : m_workers(size_t(workers < 1 ? 1 : workers)), m_start(std::chrono::steady_clock::now()) {}
+
+std::string mk::Metrics::to_openmetrics() const
+{
+    std::ostringstream out;
+
+    write_counter(out, "meshes", "Meshes whose kernel was computed or rejected by a certificate.", sum_over(m_workers, &worker_metrics::meshes));
+    write_counter(out, "load_failures", "Inputs that could not be loaded or are not closed genus 0 meshes.", sum_over(m_workers, &worker_metrics::load_failures));
+    write_counter(out, "convex_inputs", "Convex inputs (the kernel is the input).", sum_over(m_workers, &worker_metrics::convex_inputs));
+    write_counter(out, "empty_kernels", "Meshes with an empty kernel.", sum_over(m_workers, &worker_metrics::empty_kernels));
+    write_counter(out, "lp_early_outs", "Empty kernels found by the exact LP before the clipper finished.", sum_over(m_workers, &worker_metrics::lp_early_outs));
+    write_counter(out, "certificate_rejects", "Empty kernels proven by a stored certificate.", sum_over(m_workers, &worker_metrics::certificate_rejects));
+    write_counter(out, "small_mesh_paths", "Meshes clipped by the small input path.", sum_over(m_workers, &worker_metrics::small_mesh_paths));
+    write_counter(out, "planes", "Unique cutting planes.", sum_over(m_workers, &worker_metrics::planes));
+    write_counter(out, "concave_planes", "Cutting planes of concave input edges.", sum_over(m_workers, &worker_metrics::concave_planes));
+    write_counter(out, "culled_planes", "Cutting planes rejected by the bounding volume test.", sum_over(m_workers, &worker_metrics::culled_planes));
+
+    auto const planes = sum_over(m_workers, &worker_metrics::planes);
+    auto const culled = sum_over(m_workers, &worker_metrics::culled_planes);
+    write_gauge(out, "cull_rate", "Culled planes / cutting planes.", planes > 0 ? double(culled) / double(planes) : 0.0);
+    write_gauge(out, "queue_depth", "Meshes waiting for a worker.", double(m_queue_depth.load(std::memory_order_relaxed)));
+
+    auto const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    out << "# TYPE mesh_kernel_worker_utilization gauge\n";
+    out << "# HELP mesh_kernel_worker_utilization Fraction of the wall clock time a worker spent on meshes.\n";
+    for (size_t w = 0; w < m_workers.size(); ++w)
+    {
+        auto const busy = m_workers[w].busy_seconds.load(std::memory_order_relaxed);
+        out << "mesh_kernel_worker_utilization{worker=\"" << w << "\"} " << (elapsed > 0 ? busy / elapsed : 0.0) << '\n';
+    }
+
+    out << "# TYPE mesh_kernel_phase_seconds histogram\n";
+    out << "# HELP mesh_kernel_phase_seconds Latency of the phases of one mesh.\n";
+    for (size_t p = 0; p < size_t(metrics_phase::count); ++p)
+    {
+        auto const phase = to_string(metrics_phase(p));
+
+        auto cumulative = uint64_t(0);
+        for (size_t b = 0; b <= worker_metrics::bucket_bounds.size(); ++b)
+        {
+            for (auto const& w : m_workers)
+                cumulative += w.phases[p].buckets[b].load(std::memory_order_relaxed);
+
+            out << "mesh_kernel_phase_seconds_bucket{phase=\"" << phase << "\",le=\"";
+            if (b < worker_metrics::bucket_bounds.size())
+                out << worker_metrics::bucket_bounds[b];
+            else
+                out << "+Inf";
+            out << "\"} " << cumulative << '\n';
+        }
+
+        auto sum = 0.0;
+        auto count = uint64_t(0);
+        for (auto const& w : m_workers)
+        {
+            sum += w.phases[p].sum.load(std::memory_order_relaxed);
+            count += w.phases[p].count.load(std::memory_order_relaxed);
+        }
+        out << "mesh_kernel_phase_seconds_sum{phase=\"" << phase << "\"} " << sum << '\n';
+        out << "mesh_kernel_phase_seconds_count{phase=\"" << phase << "\"} " << count << '\n';
+    }
+
+    out << "# EOF\n";
+    return out.str();
+}
+
+bool mk::Metrics::write_file(std::string const& path) const
+{
+    auto const tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path);
+        if (!(out << to_openmetrics()))
+            return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    return !ec;
+}
+
+mk::MetricsServer::MetricsServer(Metrics const& metrics, int port) : m_metrics(metrics)
+{
+#if defined(__linux__)
+    m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (m_socket < 0)
+    {
+        LOGD(Default, Error, "could not create the metrics socket");
+        return;
+    }
+
+    int reuse = 1;
+    ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(uint16_t(port));
+    if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_socket, 4) != 0)
+    {
+        LOGD(Default, Error, "could not listen on 127.0.0.1:%s for metrics", port);
+        ::close(m_socket);
+        m_socket = -1;
+        return;
+    }
+
+    LOGD(Default, Info, "serving metrics on http://127.0.0.1:%s/metrics", port);
+    m_thread = std::thread([this] { run(); });
+#else
+    (void)port;
+    LOGD(Default, Warning, "the metrics endpoint is only available on linux");
+#endif
+}
+
+mk::MetricsServer::~MetricsServer()
+{
+    m_shutdown.store(true, std::memory_order_relaxed);
+    if (m_thread.joinable())
+        m_thread.join();
+
+#if defined(__linux__)
+    if (m_socket >= 0)
+        ::close(m_socket);
+#endif
+}
+
+void mk::MetricsServer::run()
+{
+#if defined(__linux__)
+    while (!m_shutdown.load(std::memory_order_relaxed))
+    {
+        // wake up regularly to notice the shutdown
+        pollfd listening = {m_socket, POLLIN, 0};
+        if (::poll(&listening, 1, 200) <= 0)
+            continue;
+
+        auto const connection = ::accept(m_socket, nullptr, nullptr);
+        if (connection < 0)
+            continue;
+
+        // a client that does not send or read must not block the thread (and the join in the destructor)
+        timeval const timeout = {1, 0};
+        ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        // the request line is all we look at
+        char request[1024];
+        auto const received = ::recv(connection, request, sizeof(request) - 1, 0);
+        auto const is_metrics = received > 0 && std::string_view(request, size_t(received)).starts_with("GET /metrics");
+
+        std::string response;
+        if (is_metrics)
+        {
+            auto const body = m_metrics.to_openmetrics();
+            response = "HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\nContent-Length: "
+                       + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        }
+        else
+            response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+        auto sent = size_t(0);
+        while (sent < response.size())
+        {
+            auto const n = ::send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                break;
+            sent += size_t(n);
+        }
+        ::close(connection);
+    }
+#endif
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// internal
+#include <core/benchmark_data.hh>
+
+namespace mk
+{
+/// phases of a mesh with a latency histogram, load is measured by the caller, total is load + compute
+enum class metrics_phase : uint8_t
+{
+    load,
+    input_planes,
+    edge_state,
+    cutting_planes,
+    supporting_structure,
+    cutting,
+    finalize,
+    total,
+    count,
+};
+
+char const* to_string(metrics_phase phase);
+
+/// counters of one worker: written only by that worker, read by the exporter
+/// single writer: relaxed load + store instead of read-modify-write, the exporter may see a mesh half added
+/// aligned to its own cache lines so workers never share a line
+struct alignas(64) worker_metrics
+{
+    /// upper bounds of the latency buckets in seconds (OpenMetrics "le"), +Inf is implicit
+    static constexpr std::array<double, 12> bucket_bounds = {0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1.0, 5.0, 10.0, 60.0, 300.0};
+
+    struct histogram
+    {
+        std::array<std::atomic<uint64_t>, bucket_bounds.size() + 1> buckets = {}; // not cumulative, the last one is +Inf
+        std::atomic<double> sum = 0.0;
+        std::atomic<uint64_t> count = 0;
+    };
+
+    std::array<histogram, size_t(metrics_phase::count)> phases;
+
+    std::atomic<uint64_t> meshes = 0;
+    std::atomic<uint64_t> load_failures = 0;
+    std::atomic<uint64_t> convex_inputs = 0;
+    std::atomic<uint64_t> empty_kernels = 0;
+    std::atomic<uint64_t> lp_early_outs = 0;
+    std::atomic<uint64_t> certificate_rejects = 0;
+    std::atomic<uint64_t> small_mesh_paths = 0;
+    std::atomic<uint64_t> planes = 0;
+    std::atomic<uint64_t> concave_planes = 0;
+    std::atomic<uint64_t> culled_planes = 0;
+    std::atomic<double> busy_seconds = 0.0; // time spent on meshes, for the utilization
+
+    void observe(metrics_phase phase, double seconds);
+
+    /// one computed mesh (load_seconds is also added to the load histogram)
+    void add_mesh(benchmark_data const& stats, double load_seconds, bool has_kernel);
+
+    /// a mesh that was rejected by its certificate or could not be loaded
+    void add_certificate_reject(double seconds);
+    void add_load_failure(double seconds);
+};
+
+/// per-worker counters of a batch, exported in the OpenMetrics text format (also readable by Prometheus)
+/// all values are summed over the workers at export time, the workers never synchronize with each other
+class Metrics
+{
+public:
+    explicit Metrics(int workers = 1);
+
+    worker_metrics& worker(int i) { return m_workers[i]; }
+    int worker_count() const { return int(m_workers.size()); }
+
+    /// meshes waiting for a worker
+    void set_queue_depth(uint64_t depth) { m_queue_depth.store(depth, std::memory_order_relaxed); }
+
+    /// the full exposition, ends with "# EOF"
+    std::string to_openmetrics() const;
+
+    /// writes to_openmetrics() to path.tmp and renames it, scrapers never see a partial file
+    bool write_file(std::string const& path) const;
+
+private:
+    std::vector<worker_metrics> m_workers; // never resized, the counters do not move
+    std::atomic<uint64_t> m_queue_depth = 0;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/// serves GET /metrics of a Metrics on 127.0.0.1:port from its own thread (linux only, one connection at a time)
+class MetricsServer
+{
+public:
+    MetricsServer(Metrics const& metrics, int port);
+    ~MetricsServer();
+
+    MetricsServer(MetricsServer const&) = delete;
+    MetricsServer& operator=(MetricsServer const&) = delete;
+
+    bool is_running() const { return m_socket >= 0; }
+
+private:
+    void run();
+
+private:
+    Metrics const& m_metrics;
+    int m_socket = -1;
+    std::atomic<bool> m_shutdown = false;
+    std::thread m_thread;
+};
+}
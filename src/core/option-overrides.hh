@@ -0,0 +1,91 @@
+#pragma once
+
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace mk
+{
+/// applies a list of "key=value" pairs separated by ',' to an introspectable struct (e.g. kernel_options)
+/// bools accept 1/0, true/false and on/off, numbers are parsed as the type of the field
+/// returns false and sets error (if not null) on unknown keys or malformed values, fields before the error are already applied
+template <class T>
+bool apply_overrides(std::string_view text, T& obj, std::string* error = nullptr)
+{
+    auto const fail = [&](std::string msg)
+    {
+        if (error)
+            *error = std::move(msg);
+        return false;
+    };
+
+    while (!text.empty())
+    {
+        auto const sep = text.find(',');
+        auto const pair = text.substr(0, sep);
+        text = sep == std::string_view::npos ? std::string_view{} : text.substr(sep + 1);
+
+        if (pair.empty())
+            continue;
+
+        auto const eq = pair.find('=');
+        if (eq == std::string_view::npos)
+            return fail("expected key=value, got '" + std::string(pair) + "'");
+
+        auto const key = pair.substr(0, eq);
+        auto const value = pair.substr(eq + 1);
+
+        auto found = false;
+        auto valid = true;
+        introspect(
+            [&](auto& field, char const* name)
+            {
+                if (found || key != name)
+                    return;
+                found = true;
+
+                using field_t = std::decay_t<decltype(field)>;
+                if constexpr (std::is_same_v<field_t, bool>)
+                {
+                    if (value == "1" || value == "true" || value == "on")
+                        field = true;
+                    else if (value == "0" || value == "false" || value == "off")
+                        field = false;
+                    else
+                        valid = false;
+                }
+                else if constexpr (std::is_integral_v<field_t>)
+                {
+                    field_t v = {};
+                    auto const [end, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+                    valid = ec == std::errc() && end == value.data() + value.size();
+                    if (valid)
+                        field = v;
+                }
+                else if constexpr (std::is_floating_point_v<field_t>)
+                {
+                    auto const s = std::string(value);
+                    char* end = nullptr;
+                    auto const v = std::strtod(s.c_str(), &end);
+                    valid = !s.empty() && end == s.c_str() + s.size();
+                    if (valid)
+                        field = field_t(v);
+                }
+                else
+                {
+                    valid = false; // not configurable from text
+                }
+            },
+            obj);
+
+        if (!found)
+            return fail("unknown option '" + std::string(key) + "'");
+        if (!valid)
+            return fail("invalid value '" + std::string(value) + "' for option '" + std::string(key) + "'");
+    }
+
+    return true;
+}
+}
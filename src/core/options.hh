@@ -11,6 +11,12 @@ struct kernel_options
     bool triangulate = false;
     bool parallel_exact_lp = true;
     int min_faces_for_parallel_setup = 100'000;
+    bool record_plane_costs = false; // per-plane timing and outcome, see KernelPlaneCut::plane_costs
+    int small_mesh_max_faces = 2'000; // smaller inputs use the SmallPolytope clipper without helper threads (0 = disabled), see mesh-kernel-small-mesh --verify
+    bool record_cut_log = false; // planes and decisions of the clipper for KernelPlaneCut::replay, see cut-log.hh
+    double min_kernel_volume = 0.0; // smaller kernels are reported as too small, clipping stops once the volume drops below (0 = disabled)
+
+    bool operator==(kernel_options const&) const = default;
 };
 
 template <class I>
@@ -23,5 +29,9 @@ void introspect(I&& i, kernel_options& v)
     i(v.triangulate, "triangulate");
     i(v.parallel_exact_lp, "parallel_exact_lp");
     i(v.min_faces_for_parallel_setup, "min_faces_for_parallel_setup");
+    i(v.record_plane_costs, "record_plane_costs");
+    i(v.small_mesh_max_faces, "small_mesh_max_faces");
+    i(v.record_cut_log, "record_cut_log");
+    i(v.min_kernel_volume, "min_kernel_volume");
 }
 }
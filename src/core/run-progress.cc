@@ -0,0 +1,175 @@
+#include "run-progress.hh"
+
+#include <chrono>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <csignal>
+#endif
+
+#include <rich-log/log.hh>
+
+#include <babel-serializer/data/json.hh>
+#include <babel-serializer/file.hh>
+
+namespace
+{
+/// set by the signal handler, consumed by the reporter thread (a handler may only touch lock-free atomics)
+std::atomic<bool> s_dump_requested = false;
+static_assert(std::atomic<bool>::is_always_lock_free);
+
+#if defined(__linux__)
+extern "C" void request_dump(int) { s_dump_requested.store(true, std::memory_order_relaxed); }
+#endif
+
+/// the reporter wakes up this often to check for a requested dump
+constexpr auto poll_interval = std::chrono::milliseconds(100);
+}
+
+char const* mk::to_string(run_phase phase)
+{
+    switch (phase)
+    {
+    case run_phase::idle:
+        return "idle";
+    case run_phase::loading:
+        return "loading";
+    case run_phase::input_planes:
+        return "input planes";
+    case run_phase::edge_state:
+        return "edge state";
+    case run_phase::cutting_planes:
+        return "cutting planes";
+    case run_phase::supporting_structure:
+        return "supporting structure";
+    case run_phase::cutting:
+        return "cutting";
+    case run_phase::finalize:
+        return "finalize";
+    }
+    return "unknown";
+}
+
+char const* mk::to_string(lp_state state)
+{
+    switch (state)
+    {
+    case lp_state::not_started:
+        return "not started";
+    case lp_state::running:
+        return "running";
+    case lp_state::feasible:
+        return "feasible";
+    case lp_state::infeasible:
+        return "infeasible";
+    }
+    return "unknown";
+}
+
+void mk::run_progress::publish(benchmark_data const& data)
+{
+    std::lock_guard lock(m_mutex);
+    m_published = data;
+}
+
+mk::benchmark_data mk::run_progress::published() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_published;
+}
+
+mk::ProgressReporter::ProgressReporter(run_progress const& progress, double interval_seconds, std::string status_path)
+  : m_progress(progress), m_interval_seconds(interval_seconds), m_status_path(std::move(status_path)), m_start(std::chrono::steady_clock::now())
+{
+#if defined(__linux__)
+    std::signal(SIGUSR1, request_dump);
+#endif
+    m_thread = std::thread([this] { run(); });
+}
+
+mk::ProgressReporter::~ProgressReporter()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+#if defined(__linux__)
+    std::signal(SIGUSR1, SIG_DFL);
+#endif
+
+    // the final state
+    if (!m_status_path.empty())
+        write_status_file(snapshot());
+}
+
+mk::progress_snapshot mk::ProgressReporter::snapshot() const
+{
+    progress_snapshot s;
+    s.phase = to_string(m_progress.phase.load(std::memory_order_relaxed));
+    s.lp = to_string(m_progress.lp.load(std::memory_order_relaxed));
+    s.planes_done = m_progress.planes_done.load(std::memory_order_relaxed);
+    s.planes_total = m_progress.planes_total.load(std::memory_order_relaxed);
+    s.batch_done = m_progress.batch_done.load(std::memory_order_relaxed);
+    s.batch_total = m_progress.batch_total.load(std::memory_order_relaxed);
+    s.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    s.stats = m_progress.published();
+    return s;
+}
+
+void mk::ProgressReporter::write_status_file(progress_snapshot const& s) const
+{
+    // readers never see a partially written file
+    auto const tmp_path = m_status_path + ".tmp";
+    babel::file::write(tmp_path, babel::json::to_string(s));
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, m_status_path, ec);
+    if (ec)
+        LOGD(Default, Warning, "could not write the status file %s", m_status_path);
+}
+
+void mk::ProgressReporter::run()
+{
+    using clock = std::chrono::steady_clock;
+
+    // the status file alone is rewritten every second
+    auto const interval_seconds = m_interval_seconds > 0 ? m_interval_seconds : 1.0;
+    auto const interval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(interval_seconds));
+    auto const periodic = m_interval_seconds > 0 || !m_status_path.empty();
+    auto next_report = clock::now() + interval;
+
+    std::unique_lock lock(m_mutex);
+    while (!m_shutdown)
+    {
+        m_cv.wait_for(lock, poll_interval, [&] { return m_shutdown; });
+        if (m_shutdown)
+            break;
+
+        if (s_dump_requested.exchange(false, std::memory_order_relaxed))
+        {
+            auto const s = snapshot();
+            LOGD(Default, Info, "[status] SIGUSR1: %s", babel::json::to_string(s));
+            if (!m_status_path.empty())
+                write_status_file(s);
+        }
+
+        if (!periodic || clock::now() < next_report)
+            continue;
+        next_report += interval;
+
+        auto const s = snapshot();
+        if (m_interval_seconds > 0)
+        {
+            if (s.batch_total > 0)
+                LOGD(Default, Info, "[status] %s: %s/%s planes, lp %s, batch %s/%s, %s s", s.phase, s.planes_done, s.planes_total, s.lp, s.batch_done,
+                     s.batch_total, int(s.elapsed_seconds));
+            else
+                LOGD(Default, Info, "[status] %s: %s/%s planes, lp %s, %s s", s.phase, s.planes_done, s.planes_total, s.lp, int(s.elapsed_seconds));
+        }
+        if (!m_status_path.empty())
+            write_status_file(s);
+    }
+}
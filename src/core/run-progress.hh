@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <clean-core/string.hh>
+
+// internal
+#include <core/benchmark_data.hh>
+
+namespace mk
+{
+enum class run_phase : uint8_t
+{
+    idle,
+    loading,
+    input_planes,
+    edge_state,
+    cutting_planes,
+    supporting_structure,
+    cutting,
+    finalize,
+};
+
+char const* to_string(run_phase phase);
+
+/// state of the exact LP racing the clipper (kernel_options::parallel_exact_lp)
+enum class lp_state : uint8_t
+{
+    not_started,
+    running,
+    feasible,
+    infeasible,
+};
+
+char const* to_string(lp_state state);
+
+/// counters of a long run for progress reports while it is running
+/// written by KernelPlaneCut and the batch loop with relaxed atomics: a reader sees every counter eventually, but not
+/// necessarily consistent with the others (e.g. the plane count of the next phase together with the old phase)
+/// the cutting loop stores one counter per plane and nothing else
+struct run_progress
+{
+    std::atomic<run_phase> phase = run_phase::idle;
+    std::atomic<lp_state> lp = lp_state::not_started;
+    std::atomic<uint64_t> planes_done = 0;
+    std::atomic<uint64_t> planes_total = 0;
+    std::atomic<uint64_t> batch_done = 0;
+    std::atomic<uint64_t> batch_total = 0; // 0 outside of batch mode
+
+    /// stats of the current input as of the last phase boundary (never called inside the cutting loop)
+    void publish(benchmark_data const& data);
+    benchmark_data published() const;
+
+private:
+    mutable std::mutex m_mutex;
+    benchmark_data m_published;
+};
+
+/// what the status file and a SIGUSR1 dump contain
+struct progress_snapshot
+{
+    cc::string phase;
+    cc::string lp;
+    uint64_t planes_done = 0;
+    uint64_t planes_total = 0;
+    uint64_t batch_done = 0;
+    uint64_t batch_total = 0;
+    double elapsed_seconds = 0.0;
+    benchmark_data stats; // as of the last phase boundary
+};
+
+template <class I>
+void introspect(I&& i, progress_snapshot& s)
+{
+    i(s.phase, "phase");
+    i(s.lp, "lp");
+    i(s.planes_done, "planes_done");
+    i(s.planes_total, "planes_total");
+    i(s.batch_done, "batch_done");
+    i(s.batch_total, "batch_total");
+    i(s.elapsed_seconds, "elapsed_seconds");
+    i(s.stats, "stats");
+}
+
+/// reads a run_progress on its own thread: logs a status line and rewrites a status file (json, replaced atomically)
+/// every interval, and logs a full snapshot when the process receives SIGUSR1 (linux only)
+/// the run itself never waits for the reporter
+class ProgressReporter
+{
+public:
+    /// interval_seconds <= 0 disables the status line (the status file is then rewritten every second)
+    /// an empty status_path disables the status file
+    ProgressReporter(run_progress const& progress, double interval_seconds, std::string status_path);
+    ~ProgressReporter();
+
+    ProgressReporter(ProgressReporter const&) = delete;
+    ProgressReporter& operator=(ProgressReporter const&) = delete;
+
+    progress_snapshot snapshot() const;
+
+private:
+    void run();
+    void write_status_file(progress_snapshot const& s) const;
+
+private:
+    run_progress const& m_progress;
+    double m_interval_seconds;
+    std::string m_status_path;
+    std::chrono::steady_clock::time_point m_start;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_shutdown = false;
+};
+}
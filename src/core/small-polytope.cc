@@ -0,0 +1,232 @@
+#include "small-polytope.hh"
+
+#include <typed-geometry/tg.hh>
+
+#include <integer-plane-geometry/classify.hh>
+#include <integer-plane-geometry/intersect.hh>
+
+bool mk::SmallPolytope::init_box(pos_t min, pos_t max)
+{
+    m_planes.clear();
+    m_plane_source.clear();
+    m_vertices.clear();
+    m_vertex_dpos.clear();
+    m_faces.clear();
+    m_corner_vertex.clear();
+    m_corner_neighbour.clear();
+
+    if (!(min.x < max.x && min.y < max.y && min.z < max.z))
+        return false;
+
+    //* vertex i has the max coordinate along x if bit 0 is set, y for bit 1, z for bit 2
+    for (auto i = 0; i < 8; ++i)
+    {
+        auto const p = pos_t(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z);
+        m_vertices.push_back(point4_t(p));
+        m_vertex_dpos.push_back(ipg::to_dpos3(m_vertices.back()));
+    }
+
+    using normal_t = tg::vec<3, typename geometry_t::normal_scalar_t>;
+    m_planes.push_back(plane_t::from_pos_normal(min, normal_t(-1, 0, 0)));
+    m_planes.push_back(plane_t::from_pos_normal(max, normal_t(1, 0, 0)));
+    m_planes.push_back(plane_t::from_pos_normal(min, normal_t(0, -1, 0)));
+    m_planes.push_back(plane_t::from_pos_normal(max, normal_t(0, 1, 0)));
+    m_planes.push_back(plane_t::from_pos_normal(min, normal_t(0, 0, -1)));
+    m_planes.push_back(plane_t::from_pos_normal(max, normal_t(0, 0, 1)));
+    m_plane_source.assign(6, -1);
+
+    // counter-clockwise seen from outside, same order as the planes
+    int const loops[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+    for (auto f = 0; f < 6; ++f)
+    {
+        m_faces.push_back({f, int(m_corner_vertex.size()), 4});
+        for (auto i = 0; i < 4; ++i)
+        {
+            auto const from = loops[f][i];
+            auto const to = loops[f][(i + 1) % 4];
+
+            // the neighbouring face has the reversed edge
+            auto neighbour = -1;
+            for (auto g = 0; g < 6 && neighbour < 0; ++g)
+                for (auto j = 0; j < 4; ++j)
+                    if (g != f && loops[g][j] == to && loops[g][(j + 1) % 4] == from)
+                        neighbour = g;
+
+            m_corner_vertex.push_back(from);
+            m_corner_neighbour.push_back(neighbour);
+        }
+    }
+
+    collect_alive_vertices();
+    return true;
+}
+
+tg::i8 mk::SmallPolytope::classify(int v, plane_t const& plane, tg::dvec3 const& normal, double offset) const
+{
+    auto const& p = m_vertex_dpos[v];
+    auto const value = normal.x * p.x + normal.y * p.y + normal.z * p.z + offset;
+
+    // the rounding of the position and of the plane is far below this bound
+    auto const bound = 1e-9 * (tg::abs(normal.x * p.x) + tg::abs(normal.y * p.y) + tg::abs(normal.z * p.z) + tg::abs(offset));
+    if (value > bound)
+        return 1;
+    if (value < -bound)
+        return -1;
+
+    return ipg::classify(m_vertices[v], plane);
+}
+
+int mk::SmallPolytope::edge_vertex(int from, int to, int face_plane, int neighbour_plane, int cut_plane)
+{
+    auto const a = tg::min(from, to);
+    auto const b = tg::max(from, to);
+    for (auto const& e : m_edge_vertices)
+        if (e.a == a && e.b == b)
+            return e.vertex;
+
+    auto const v = int(m_vertices.size());
+    m_vertices.push_back(ipg::intersect(m_planes[face_plane], m_planes[neighbour_plane], m_planes[cut_plane]));
+    m_vertex_dpos.push_back(ipg::to_dpos3(m_vertices.back()));
+    m_edge_vertices.push_back({a, b, v});
+    return v;
+}
+
+void mk::SmallPolytope::collect_alive_vertices()
+{
+    ++m_current_stamp;
+    m_stamp.resize(m_vertices.size(), 0);
+    m_side.resize(m_vertices.size(), 0);
+
+    m_alive.clear();
+    auto min = m_vertex_dpos[m_corner_vertex.front()];
+    auto max = min;
+    for (auto const v : m_corner_vertex)
+        if (m_stamp[v] != m_current_stamp)
+        {
+            m_stamp[v] = m_current_stamp;
+            m_alive.push_back(v);
+            min = tg::min(min, m_vertex_dpos[v]);
+            max = tg::max(max, m_vertex_dpos[v]);
+        }
+
+    // one unit outwards covers the rounding of the positions
+    m_bounds.min = tg::ipos3(int(tg::floor(min.x)) - 1, int(tg::floor(min.y)) - 1, int(tg::floor(min.z)) - 1);
+    m_bounds.max = tg::ipos3(int(tg::ceil(max.x)) + 1, int(tg::ceil(max.y)) + 1, int(tg::ceil(max.z)) + 1);
+}
+
+mk::SmallPolytope::cut_result mk::SmallPolytope::cut(plane_t const& plane, int source)
+{
+    //* classify
+    auto const normal = tg::dvec3(double(plane.a), double(plane.b), double(plane.c));
+    auto const offset = double(plane.d);
+
+    auto positive = 0;
+    auto negative = 0;
+    for (auto const v : m_alive)
+    {
+        auto const s = classify(v, plane, normal, offset);
+        m_side[v] = s;
+        positive += s > 0;
+        negative += s < 0;
+    }
+
+    if (positive == 0)
+        return cut_result::redundant;
+    if (negative == 0)
+        return cut_result::empty;
+
+    auto const cut_plane = int(m_planes.size());
+    m_planes.push_back(plane);
+    m_plane_source.push_back(source);
+
+    m_next_faces.clear();
+    m_next_corner_vertex.clear();
+    m_next_corner_neighbour.clear();
+    m_edge_vertices.clear();
+    m_cap_edges.clear();
+
+    auto const emit = [&](int vertex, int neighbour_plane)
+    {
+        m_next_corner_vertex.push_back(vertex);
+        m_next_corner_neighbour.push_back(neighbour_plane);
+    };
+
+    //* clip every face, corners on the cut plane get the cap as neighbour
+    for (auto const& f : m_faces)
+    {
+        auto const first = int(m_next_corner_vertex.size());
+        for (auto i = 0; i < f.corner_count; ++i)
+        {
+            auto const u = m_corner_vertex[f.first_corner + i];
+            auto const v = m_corner_vertex[f.first_corner + (i + 1) % f.corner_count];
+            auto const neighbour = m_corner_neighbour[f.first_corner + i];
+            auto const su = m_side[u];
+            auto const sv = m_side[v];
+
+            if (su < 0)
+            {
+                emit(u, neighbour);
+                if (sv > 0)
+                    emit(edge_vertex(u, v, f.plane, neighbour, cut_plane), cut_plane);
+            }
+            else if (su == 0)
+            {
+                // an edge along the cut plane of a kept face always borders a removed face (the cut is proper)
+                emit(u, sv < 0 ? neighbour : cut_plane);
+            }
+            else if (sv < 0)
+            {
+                emit(edge_vertex(u, v, f.plane, neighbour, cut_plane), neighbour);
+            }
+        }
+
+        auto const count = int(m_next_corner_vertex.size()) - first;
+        if (count < 3)
+        {
+            // face is cut away (or only touches the plane)
+            m_next_corner_vertex.resize(first);
+            m_next_corner_neighbour.resize(first);
+            continue;
+        }
+
+        m_next_faces.push_back({f.plane, first, count});
+        for (auto j = 0; j < count; ++j)
+            if (m_next_corner_neighbour[first + j] == cut_plane)
+                m_cap_edges.push_back({m_next_corner_vertex[first + (j + 1) % count], m_next_corner_vertex[first + j], f.plane});
+    }
+
+    //* close the cap by chaining its (reversed) edges
+    auto const cap_size = int(m_cap_edges.size());
+    if (cap_size < 3)
+        return cut_result::failed;
+
+    auto const first = int(m_next_corner_vertex.size());
+    auto current = 0;
+    for (auto step = 0; step < cap_size; ++step)
+    {
+        emit(m_cap_edges[current].from, m_cap_edges[current].neighbour_plane);
+
+        auto next = -1;
+        for (auto k = 0; k < cap_size && next < 0; ++k)
+            if (m_cap_edges[k].from == m_cap_edges[current].to)
+                next = k;
+
+        if (next < 0)
+            return cut_result::failed;
+        current = next;
+        if (current == 0)
+            break;
+    }
+
+    if (current != 0 || int(m_next_corner_vertex.size()) - first != cap_size)
+        return cut_result::failed;
+
+    m_next_faces.push_back({cut_plane, first, cap_size});
+
+    std::swap(m_faces, m_next_faces);
+    std::swap(m_corner_vertex, m_next_corner_vertex);
+    std::swap(m_corner_neighbour, m_next_corner_neighbour);
+    collect_alive_vertices();
+
+    return cut_result::cut;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <vector>
+
+#include <clean-core/span.hh>
+
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+#include <integer-plane-geometry/point.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+namespace mk
+{
+/// exact convex polytope for small inputs, stored as a list of faces (plane + vertex loop)
+/// every vertex is the intersection of three planes, every face corner stores the plane of the neighbouring face across
+/// the outgoing edge, so new vertices are computed exactly without a halfedge mesh
+///
+/// all storage is kept between calls (cleared, not freed), after the first mesh of a batch no allocations happen
+/// there are no helper threads and no acceleration structures, a cut classifies every vertex (with a floating point filter)
+class SmallPolytope
+{
+public: // types
+    using geometry_t = ipg::geometry<26, 55>;
+    using pos_t = typename geometry_t::pos_t;
+    using point4_t = typename geometry_t::point4_t;
+    using plane_t = typename geometry_t::plane_t;
+
+    enum class cut_result
+    {
+        redundant, // the polytope is entirely on the negative side
+        cut,
+        empty,  // nothing with volume is left
+        failed, // the cap of a degenerate cut could not be closed, the caller has to use the full engine
+    };
+
+    struct face
+    {
+        int plane = -1;
+        int first_corner = 0;
+        int corner_count = 0;
+    };
+
+public: // API
+    /// starts with the box [min, max], returns false if it has no volume
+    bool init_box(pos_t min, pos_t max);
+
+    /// keeps the part with plane(x) <= 0, source is stored with the plane (box planes have source -1)
+    cut_result cut(plane_t const& plane, int source);
+
+    cc::span<face const> faces() const { return m_faces; }
+
+    /// corner i of a face is m_corner_vertex[face.first_corner + i], counter-clockwise seen from outside
+    int corner_vertex(face const& f, int i) const { return m_corner_vertex[f.first_corner + i]; }
+
+    point4_t const& vertex(int v) const { return m_vertices[v]; }
+    int vertex_count() const { return int(m_vertices.size()); }
+
+    plane_t const& plane(int p) const { return m_planes[p]; }
+    int plane_source(int p) const { return m_plane_source[p]; }
+
+    /// integer box containing the polytope, updated by every cut (the bounding volume culling of this path)
+    tg::iaabb3 const& bounds() const { return m_bounds; }
+
+private:
+    /// exact sign of plane(vertex), decided in double if the value is far enough from 0
+    tg::i8 classify(int v, plane_t const& plane, tg::dvec3 const& normal, double offset) const;
+
+    /// vertex on the edge between the faces with planes face_plane and neighbour_plane, created once per edge
+    int edge_vertex(int from, int to, int face_plane, int neighbour_plane, int cut_plane);
+
+    /// rebuilds m_alive from the face corners
+    void collect_alive_vertices();
+
+private:
+    struct edge_vertex_entry
+    {
+        int a, b; // a < b
+        int vertex;
+    };
+
+    struct cap_edge
+    {
+        int from, to;
+        int neighbour_plane;
+    };
+
+    std::vector<plane_t> m_planes;
+    std::vector<int> m_plane_source;
+
+    std::vector<point4_t> m_vertices;
+    std::vector<tg::dpos3> m_vertex_dpos; // rounded, only used by the floating point filter and for m_bounds
+    tg::iaabb3 m_bounds;
+
+    std::vector<face> m_faces;
+    std::vector<int> m_corner_vertex;
+    std::vector<int> m_corner_neighbour; // plane of the face across the edge to the next corner
+
+    //* scratch buffers of cut()
+    std::vector<face> m_next_faces;
+    std::vector<int> m_next_corner_vertex;
+    std::vector<int> m_next_corner_neighbour;
+    std::vector<int> m_alive;
+    std::vector<int> m_stamp;
+    int m_current_stamp = 0;
+    std::vector<tg::i8> m_side;
+    std::vector<edge_vertex_entry> m_edge_vertices;
+    std::vector<cap_edge> m_cap_edges;
+};
+}
@@ -0,0 +1,230 @@
+#include "stats-writer.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include <clean-core/assert.hh>
+
+#include <rich-log/log.hh>
+
+namespace
+{
+constexpr char stats_magic[8] = {'M', 'K', 'S', 'T', 'A', 'T', 'S', '1'};
+constexpr char row_group_magic[4] = {'R', 'G', 'R', 'P'};
+
+template <class T>
+void append_pod(cc::vector<uint8_t>& out, T const& value)
+{
+    auto const offset = out.size();
+    out.resize(offset + sizeof(T));
+    std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void append_csv_string(std::string& line, cc::string_view value)
+{
+    line += '"';
+    for (auto const c : value)
+    {
+        if (c == '"')
+            line += '"';
+        line += c;
+    }
+    line += '"';
+}
+}
+
+void mk::StatsWriter::open(std::string const& path, int row_group_size)
+{
+    close();
+
+    m_path = path;
+    m_row_group_size = row_group_size > 0 ? row_group_size : 4096;
+    m_failed = false;
+    m_files_open = false;
+    m_columns.clear();
+    m_rows_in_group = 0;
+    m_rows_written = 0;
+}
+
+void mk::StatsWriter::close()
+{
+    flush();
+    m_csv.close();
+    m_path.clear();
+    m_files_open = false;
+}
+
+mk::StatsWriter::column& mk::StatsWriter::next_column(char const* name, stats_column_type type)
+{
+    if (!m_files_open && m_rows_written == 0 && m_rows_in_group == 0)
+    {
+        // first row defines the schema
+        if (m_current_column == m_columns.size())
+        {
+            auto& c = m_columns.emplace_back();
+            c.name = name;
+            c.type = type;
+        }
+    }
+
+    CC_ASSERT(m_current_column < m_columns.size() && "row type changed between rows");
+    auto& c = m_columns[m_current_column++];
+    CC_ASSERT(c.type == type && c.name == cc::string_view(name) && "row type changed between rows");
+    return c;
+}
+
+void mk::StatsWriter::add_bool(bool value, char const* name)
+{
+    auto& c = next_column(name, stats_column_type::boolean);
+    append_pod(c.data, uint8_t(value));
+    m_csv_line += value ? "1" : "0";
+    m_csv_line += ',';
+}
+
+void mk::StatsWriter::add_int(int64_t value, char const* name)
+{
+    auto& c = next_column(name, stats_column_type::int64);
+    append_pod(c.data, value);
+    m_csv_line += std::to_string(value);
+    m_csv_line += ',';
+}
+
+void mk::StatsWriter::add_float(double value, char const* name)
+{
+    auto& c = next_column(name, stats_column_type::float64);
+    append_pod(c.data, value);
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    m_csv_line += buffer;
+    m_csv_line += ',';
+}
+
+void mk::StatsWriter::add_string(cc::string_view value, char const* name)
+{
+    auto& c = next_column(name, stats_column_type::string);
+    append_pod(c.data, uint32_t(value.size()));
+    auto const offset = c.data.size();
+    c.data.resize(offset + value.size());
+    std::memcpy(c.data.data() + offset, value.data(), value.size());
+
+    append_csv_string(m_csv_line, value);
+    m_csv_line += ',';
+}
+
+void mk::StatsWriter::commit_row()
+{
+    CC_ASSERT(m_current_column == m_columns.size() && "row type changed between rows");
+
+    if (!m_files_open && !open_files())
+    {
+        m_failed = true;
+        return;
+    }
+
+    if (!m_csv_line.empty())
+        m_csv_line.back() = '\n';
+
+    m_csv << m_csv_line;
+    m_csv_line.clear();
+
+    if (++m_rows_in_group >= m_row_group_size)
+        flush();
+}
+
+bool mk::StatsWriter::open_files()
+{
+    // expected binary header
+    cc::vector<uint8_t> header;
+    for (auto const c : stats_magic)
+        append_pod(header, c);
+    append_pod(header, uint32_t(m_columns.size()));
+    for (auto const& c : m_columns)
+    {
+        append_pod(header, uint8_t(c.type));
+        append_pod(header, uint16_t(c.name.size()));
+        for (auto const ch : c.name)
+            append_pod(header, ch);
+    }
+
+    std::string csv_header;
+    for (auto const& c : m_columns)
+    {
+        csv_header += c.name.c_str();
+        csv_header += ',';
+    }
+    csv_header.back() = '\n';
+
+    auto const bin_path = m_path + ".mkstats";
+    auto const csv_path = m_path + ".csv";
+
+    auto const bin_exists = std::filesystem::exists(bin_path) && std::filesystem::file_size(bin_path) > 0;
+    auto const csv_exists = std::filesystem::exists(csv_path) && std::filesystem::file_size(csv_path) > 0;
+
+    if (bin_exists)
+    {
+        std::ifstream in(bin_path, std::ios::binary);
+        std::vector<uint8_t> existing(header.size());
+        in.read(reinterpret_cast<char*>(existing.data()), std::streamsize(existing.size()));
+        if (!in || std::memcmp(existing.data(), header.data(), header.size()) != 0)
+        {
+            LOGD(Default, Error, "%s has a different column layout, not appending", bin_path);
+            return false;
+        }
+    }
+    else
+    {
+        std::ofstream(bin_path, std::ios::binary).write(reinterpret_cast<char const*>(header.data()), std::streamsize(header.size()));
+    }
+
+    if (csv_exists)
+    {
+        std::ifstream in(csv_path, std::ios::binary);
+        std::string first_line;
+        std::getline(in, first_line);
+        if (first_line + '\n' != csv_header)
+        {
+            LOGD(Default, Error, "%s has a different column layout, not appending", csv_path);
+            return false;
+        }
+    }
+    else
+    {
+        std::ofstream(csv_path, std::ios::binary) << csv_header;
+    }
+
+    m_csv.open(csv_path, std::ios::app | std::ios::binary);
+    if (!m_csv)
+    {
+        LOGD(Default, Error, "could not open %s", csv_path);
+        return false;
+    }
+
+    m_files_open = true;
+    return true;
+}
+
+void mk::StatsWriter::flush()
+{
+    if (!m_files_open || m_rows_in_group == 0)
+        return;
+
+    m_csv.flush();
+
+    std::ofstream out(m_path + ".mkstats", std::ios::app | std::ios::binary);
+    auto const rows = uint32_t(m_rows_in_group);
+    out.write(row_group_magic, sizeof(row_group_magic));
+    out.write(reinterpret_cast<char const*>(&rows), sizeof(rows));
+    for (auto& c : m_columns)
+    {
+        auto const size = uint64_t(c.data.size());
+        out.write(reinterpret_cast<char const*>(&size), sizeof(size));
+        out.write(reinterpret_cast<char const*>(c.data.data()), std::streamsize(c.data.size()));
+        c.data.clear();
+    }
+
+    m_rows_written += m_rows_in_group;
+    m_rows_in_group = 0;
+}
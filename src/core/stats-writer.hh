@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+#include <clean-core/string.hh>
+#include <clean-core/string_view.hh>
+#include <clean-core/vector.hh>
+
+namespace mk
+{
+enum class stats_column_type : uint8_t
+{
+    boolean = 0,
+    int64 = 1,
+    float64 = 2,
+    string = 3,
+};
+
+/// append-only table with one row per call of write()
+/// the columns are taken from the introspect() of the row type, nested structs can be flattened by calling their introspect()
+///
+/// two files are written next to each other:
+///   <path>.csv     - header line + one line per row
+///   <path>.mkstats - binary columnar format, rows are buffered and written as row groups:
+///                    header:    "MKSTATS1", u32 column count, per column: u8 type, u16 name length, name
+///                    row group: "RGRP", u32 row count, per column: u64 byte size, values
+///                               (bool: u8, int64: i64, float64: f64, string: u32 length + bytes), little endian
+///
+/// existing files are appended to if their header matches the columns, otherwise open fails on the first row
+class StatsWriter
+{
+public:
+    StatsWriter() = default;
+    explicit StatsWriter(std::string const& path, int row_group_size = 4096) { open(path, row_group_size); }
+    ~StatsWriter() { close(); }
+
+    StatsWriter(StatsWriter const&) = delete;
+    StatsWriter& operator=(StatsWriter const&) = delete;
+
+    /// path without extension, the files are created lazily on the first row
+    void open(std::string const& path, int row_group_size = 4096);
+
+    /// writes the buffered rows and closes the files
+    void close();
+
+    /// writes the buffered rows as a row group and flushes the csv
+    void flush();
+
+    bool is_open() const { return !m_path.empty() && !m_failed; }
+
+    int64_t rows_written() const { return m_rows_written; }
+
+    template <class RowT>
+    void write(RowT const& row)
+    {
+        if (!is_open())
+            return;
+
+        m_current_column = 0;
+        auto r = row; // introspect takes non-const references
+        introspect([this](auto const& value, char const* name) { add_value(value, name); }, r);
+        commit_row();
+    }
+
+private:
+    struct column
+    {
+        cc::string name;
+        stats_column_type type = stats_column_type::int64;
+        cc::vector<uint8_t> data; // values of the current row group
+    };
+
+    template <class T>
+    void add_value(T const& value, char const* name)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+            add_bool(value, name);
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            add_int(int64_t(value), name);
+        else if constexpr (std::is_floating_point_v<T>)
+            add_float(double(value), name);
+        else
+            add_string(cc::string_view(value.data(), value.size()), name);
+    }
+
+    void add_bool(bool value, char const* name);
+    void add_int(int64_t value, char const* name);
+    void add_float(double value, char const* name);
+    void add_string(cc::string_view value, char const* name);
+
+    /// returns the column for the next value, adds it while the first row is written
+    column& next_column(char const* name, stats_column_type type);
+
+    void commit_row();
+    bool open_files();
+
+private:
+    std::string m_path;
+    int m_row_group_size = 4096;
+    bool m_failed = false;
+    bool m_files_open = false;
+
+    cc::vector<column> m_columns;
+    size_t m_current_column = 0;
+    int m_rows_in_group = 0;
+    int64_t m_rows_written = 0;
+
+    std::string m_csv_line;
+    std::ofstream m_csv;
+};
+}
@@ -0,0 +1,164 @@
+#include "vertex-weld.hh"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <typed-geometry/tg.hh>
+
+#if defined(MK_TBB_ENABLED)
+#include <tbb/tbb.h>
+#endif
+
+namespace
+{
+/// smaller inputs are welded on the calling thread
+constexpr int min_vertices_for_parallel_weld = 1 << 15;
+
+/// independent hash maps, a vertex belongs to the shard of its position hash
+constexpr size_t shard_count = 64;
+
+uint64_t hash_position(tg::ipos3 const& p)
+{
+    auto h = uint64_t(uint32_t(p.x)) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ uint64_t(uint32_t(p.y))) * 0xBF58476D1CE4E5B9ull;
+    h = (h ^ uint64_t(uint32_t(p.z))) * 0x94D049BB133111EBull;
+    return h ^ (h >> 31);
+}
+
+struct position_hash
+{
+    size_t operator()(tg::ipos3 const& p) const { return size_t(hash_position(p)); }
+};
+
+/// calls f(i) for every i in [0, count), in parallel if available and parallel is set
+template <class F>
+void for_each_index(size_t count, bool parallel, F&& f)
+{
+#if defined(MK_TBB_ENABLED)
+    if (parallel)
+    {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, count),
+                          [&](tbb::blocked_range<size_t> const& range)
+                          {
+                              for (auto i = range.begin(); i < range.end(); ++i)
+                                  f(i);
+                          });
+        return;
+    }
+#endif
+    (void)parallel;
+    for (size_t i = 0; i < count; ++i)
+        f(i);
+}
+}
+
+mk::weld_result mk::weld_vertices(pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position, pm::vertex_attribute<tg::ipos3>& int_position)
+{
+    weld_result result;
+
+    mesh.compactify();
+    auto const n_vertices = int(mesh.vertices().size());
+    auto const n_faces = int(mesh.faces().size());
+    auto const parallel = n_vertices >= min_vertices_for_parallel_weld;
+
+    //* shard of every vertex
+    std::vector<uint32_t> shard(n_vertices);
+    for_each_index(n_vertices, parallel, [&](size_t i) { shard[i] = uint32_t(hash_position(int_position[mesh.vertices()[int(i)]]) % shard_count); });
+
+    // counting sort by shard, stable: every shard lists its vertices by increasing index
+    std::vector<int> shard_begin(shard_count + 1, 0);
+    for (auto const s : shard)
+        shard_begin[s + 1]++;
+    for (size_t s = 0; s < shard_count; ++s)
+        shard_begin[s + 1] += shard_begin[s];
+    std::vector<int> shard_vertices(n_vertices);
+    {
+        auto fill = shard_begin;
+        for (auto i = 0; i < n_vertices; ++i)
+            shard_vertices[fill[shard[i]]++] = i;
+    }
+
+    //* representative (lowest index with the same position) of every vertex, one map per shard
+    std::vector<int> representative(n_vertices);
+    for_each_index(shard_count, parallel,
+                   [&](size_t s)
+                   {
+                       std::unordered_map<tg::ipos3, int, position_hash> first;
+                       first.reserve(size_t(shard_begin[s + 1] - shard_begin[s]));
+                       for (auto k = shard_begin[s]; k < shard_begin[s + 1]; ++k)
+                       {
+                           auto const i = shard_vertices[k];
+                           representative[i] = first.emplace(int_position[mesh.vertices()[i]], i).first->second;
+                       }
+                   });
+
+    //* index of every vertex in the welded mesh
+    std::vector<int> new_index(n_vertices, -1);
+    auto n_welded = 0;
+    for (auto i = 0; i < n_vertices; ++i)
+        if (representative[i] == i)
+            new_index[i] = n_welded++;
+    result.removed_vertices = n_vertices - n_welded;
+
+    std::vector<tg::dpos3> welded_position(n_welded);
+    std::vector<tg::ipos3> welded_int_position(n_welded);
+    for_each_index(n_vertices, parallel,
+                   [&](size_t i)
+                   {
+                       if (new_index[i] < 0)
+                           return;
+                       auto const v = mesh.vertices()[int(i)];
+                       welded_position[new_index[i]] = position[v];
+                       welded_int_position[new_index[i]] = int_position[v];
+                   });
+
+    //* remapped face corners
+    std::vector<int> corner_begin(n_faces + 1, 0);
+    for (auto const f : mesh.faces())
+        corner_begin[f.idx.value + 1] = int(f.vertices().size());
+    for (auto f = 0; f < n_faces; ++f)
+        corner_begin[f + 1] += corner_begin[f];
+    std::vector<int> corners(corner_begin.back());
+    for_each_index(n_faces, parallel,
+                   [&](size_t f)
+                   {
+                       auto c = corner_begin[f];
+                       for (auto const v : mesh.faces()[int(f)].vertices())
+                           corners[c++] = new_index[representative[v.idx.value]];
+                   });
+
+    //* welded topology
+    mesh.clear();
+    for (auto i = 0; i < n_welded; ++i)
+    {
+        auto const v = mesh.vertices().add();
+        position[v] = welded_position[i];
+        int_position[v] = welded_int_position[i];
+    }
+
+    std::vector<pm::vertex_handle> face_vertices;
+    for (auto f = 0; f < n_faces; ++f)
+    {
+        // drop corners that were welded into their predecessor
+        face_vertices.clear();
+        for (auto c = corner_begin[f]; c < corner_begin[f + 1]; ++c)
+            if (face_vertices.empty() || face_vertices.back().idx.value != corners[c])
+                face_vertices.push_back(mesh.vertices()[corners[c]]);
+        while (face_vertices.size() > 1 && face_vertices.back() == face_vertices.front())
+            face_vertices.pop_back();
+
+        if (face_vertices.size() < 3)
+        {
+            result.degenerate_faces++;
+            continue;
+        }
+
+        if (!mesh.faces().can_add(face_vertices.data(), face_vertices.size()))
+            return result;
+        mesh.faces().add(face_vertices.data(), face_vertices.size());
+    }
+
+    result.success = true;
+    return result;
+}
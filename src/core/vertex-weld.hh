@@ -0,0 +1,24 @@
+#pragma once
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+namespace mk
+{
+struct weld_result
+{
+    bool success = false;      // false if the welded faces are not a manifold mesh
+    int removed_vertices = 0;  // vertices merged into another one
+    int degenerate_faces = 0;  // faces that collapsed to less than three vertices and were dropped
+};
+
+/// merges all vertices with equal quantized positions and rebuilds the topology (e.g. STL triangle soups)
+/// the positions are compared exactly, no epsilon: welding happens after quantization so the kernel sees the same mesh
+/// a welded vertex keeps the position of its lowest-index original, faces keep their order
+///
+/// hashing (sharded by position hash, one map per shard) and index remapping run in parallel if tbb is enabled,
+/// the faces are added serially since polymesh links the halfedges on insertion
+/// on failure the mesh is left in an unspecified state
+weld_result weld_vertices(pm::Mesh& mesh, pm::vertex_attribute<tg::dpos3>& position, pm::vertex_attribute<tg::ipos3>& int_position);
+}
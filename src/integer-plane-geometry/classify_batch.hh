@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <clean-core/assert.hh>
+#include <clean-core/span.hh>
+
+#include <typed-geometry/feature/fixed_int.hh>
+
+#include <integer-plane-geometry/classify.hh>
+#include <integer-plane-geometry/geometry.hh>
+#include <integer-plane-geometry/plane.hh>
+#include <integer-plane-geometry/point.hh>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define IPG_BATCH_X86 1
+#include <immintrin.h>
+#else
+#define IPG_BATCH_X86 0
+#endif
+
+namespace ipg
+{
+/// implementation of the batched predicates
+enum class batch_backend
+{
+    scalar,      // one classify() per point
+    avx2,        // 4 lanes, 28 bit limbs, 32x32->64 bit partial products
+    avx512_ifma, // 8 lanes, 52 bit limbs, 52x52->104 bit partial products
+};
+
+inline char const* to_string(batch_backend b)
+{
+    switch (b)
+    {
+    case batch_backend::scalar:
+        return "scalar";
+    case batch_backend::avx2:
+        return "avx2";
+    case batch_backend::avx512_ifma:
+        return "avx512_ifma";
+    }
+    return "unknown";
+}
+
+/// true if the compiler and the cpu (and os) support the backend
+inline bool is_supported(batch_backend b)
+{
+    switch (b)
+    {
+    case batch_backend::scalar:
+        return true;
+#if IPG_BATCH_X86
+    case batch_backend::avx2:
+        return __builtin_cpu_supports("avx2");
+    case batch_backend::avx512_ifma:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+#endif
+    default:
+        return false;
+    }
+}
+
+/// fastest supported backend, detected once
+inline batch_backend best_batch_backend()
+{
+    static auto const best = []
+    {
+        if (is_supported(batch_backend::avx512_ifma))
+            return batch_backend::avx512_ifma;
+        if (is_supported(batch_backend::avx2))
+            return batch_backend::avx2;
+        return batch_backend::scalar;
+    }();
+    return best;
+}
+
+namespace detail
+{
+/// magnitude of a signed builtin integer or tg::fixed_int as little endian 64 bit words, returns true if negative
+template <class T>
+bool magnitude_words(T const& v, uint64_t (&words)[4])
+{
+    for (auto& w : words)
+        w = 0;
+
+    if constexpr (std::is_integral_v<T>)
+    {
+        words[0] = v < 0 ? uint64_t(0) - uint64_t(v) : uint64_t(v);
+        return v < 0;
+    }
+    else
+    {
+        static_assert(sizeof(T) <= sizeof(words), "at most 256 bit supported");
+        auto const negative = tg::detail::less_than_zero(v);
+        T const m = negative ? T(-v) : v;
+        for (size_t i = 0; i < sizeof(T) / 8; ++i)
+            words[i] = m.d[i];
+        return negative;
+    }
+}
+
+/// bits [limb * limb_bits, (limb + 1) * limb_bits) of the words
+inline uint64_t extract_limb(uint64_t const (&words)[4], int limb_bits, int limb)
+{
+    auto const first = limb * limb_bits;
+    auto const word = first / 64;
+    auto const shift = first % 64;
+    if (word >= 4)
+        return 0;
+
+    auto v = words[word] >> shift;
+    if (shift + limb_bits > 64 && word + 1 < 4)
+        v |= words[word + 1] << (64 - shift);
+    return v & ((uint64_t(1) << limb_bits) - 1);
+}
+
+/// limb counts of classify(point4, plane) for a limb size
+/// d = x*a + y*b + z*c + w*d is evaluated as two unsigned sums (positive and negative products) of limb-wise partial products
+template <class geometry_t, int limb_bits>
+struct batch_layout
+{
+    static constexpr int limbs_of(int bits) { return (bits + limb_bits - 1) / limb_bits; }
+
+    static constexpr int xxd_limbs = limbs_of(geometry_t::bits_determinant_xxd);
+    static constexpr int abc_limbs = limbs_of(geometry_t::bits_determinant_abc);
+    static constexpr int normal_limbs = limbs_of(geometry_t::bits_normal);
+    static constexpr int plane_d_limbs = limbs_of(geometry_t::bits_plane_d);
+
+    /// one more than the highest column of a partial product, plus one for the final carry
+    static constexpr int result_limbs = std::max(xxd_limbs + normal_limbs, abc_limbs + plane_d_limbs) + 1;
+    static constexpr int max_coef_limbs = std::max(normal_limbs, plane_d_limbs);
+
+    /// limbs of coordinate x, y, z, w start at row point_row(c) of the batch
+    static constexpr int point_row(int c) { return c * xxd_limbs; }
+    static constexpr int point_rows = 3 * xxd_limbs + abc_limbs;
+
+    static constexpr int point_limbs(int c) { return c < 3 ? xxd_limbs : abc_limbs; }
+    static constexpr int coef_limbs(int c) { return c < 3 ? normal_limbs : plane_d_limbs; }
+
+    // a column receives at most 2 * (3 * normal_limbs + plane_d_limbs) addends (lo and hi halves with 52 bit limbs),
+    // each below 2^(2 * limb_bits) for 32x32 bit products and below 2^52 for the split 52x52 bit products
+    static constexpr int addend_bits = limb_bits <= 32 ? 2 * limb_bits : 52;
+    static_assert(2 * (3 * normal_limbs + plane_d_limbs) < (int64_t(1) << (63 - addend_bits)), "column sums could overflow 64 bit");
+};
+
+/// the four coefficients of a plane split into limbs
+template <int max_limbs>
+struct plane_limbs
+{
+    uint64_t limbs[4][max_limbs] = {};
+    bool negative[4] = {};
+};
+
+template <class geometry_t, int limb_bits>
+plane_limbs<batch_layout<geometry_t, limb_bits>::max_coef_limbs> split_plane(plane<geometry_t> const& p)
+{
+    using layout = batch_layout<geometry_t, limb_bits>;
+    plane_limbs<layout::max_coef_limbs> r;
+    uint64_t words[4];
+
+    auto const split = [&](int c, auto const& v)
+    {
+        r.negative[c] = magnitude_words(v, words);
+        for (auto l = 0; l < layout::coef_limbs(c); ++l)
+            r.limbs[c][l] = extract_limb(words, limb_bits, l);
+    };
+    split(0, p.a);
+    split(1, p.b);
+    split(2, p.c);
+    split(3, p.d);
+    return r;
+}
+
+#if IPG_BATCH_X86
+
+template <class geometry_t>
+__attribute__((target("avx2"))) void classify_avx2(
+    uint64_t const* limbs, uint64_t const* negative, uint64_t const* w_zero, size_t stride, size_t n, plane<geometry_t> const& p, tg::i8* out)
+{
+    static constexpr int limb_bits = 28;
+    using layout = batch_layout<geometry_t, limb_bits>;
+    static constexpr int R = layout::result_limbs;
+
+    auto const pl = split_plane<geometry_t, limb_bits>(p);
+    __m256i q[4][layout::max_coef_limbs];
+    __m256i coef_negative[4];
+    for (auto c = 0; c < 4; ++c)
+    {
+        for (auto l = 0; l < layout::coef_limbs(c); ++l)
+            q[c][l] = _mm256_set1_epi64x(int64_t(pl.limbs[c][l]));
+        coef_negative[c] = _mm256_set1_epi64x(pl.negative[c] ? -1 : 0);
+    }
+
+    auto const limb_mask = _mm256_set1_epi64x((int64_t(1) << limb_bits) - 1);
+    auto const one = _mm256_set1_epi64x(1);
+
+    for (size_t i = 0; i < n; i += 4)
+    {
+        __m256i pos[R], neg[R];
+        for (auto k = 0; k < R; ++k)
+            pos[k] = neg[k] = _mm256_setzero_si256();
+
+        //* partial products, sorted into the positive or negative sum by the sign of the product
+        for (auto c = 0; c < 4; ++c)
+        {
+            auto const lane_negative = _mm256_xor_si256(_mm256_loadu_si256((__m256i const*)(negative + c * stride + i)), coef_negative[c]);
+            for (auto a = 0; a < layout::point_limbs(c); ++a)
+            {
+                auto const pa = _mm256_loadu_si256((__m256i const*)(limbs + (layout::point_row(c) + a) * stride + i));
+                for (auto b = 0; b < layout::coef_limbs(c); ++b)
+                {
+                    auto const prod = _mm256_mul_epu32(pa, q[c][b]);
+                    pos[a + b] = _mm256_add_epi64(pos[a + b], _mm256_andnot_si256(lane_negative, prod));
+                    neg[a + b] = _mm256_add_epi64(neg[a + b], _mm256_and_si256(lane_negative, prod));
+                }
+            }
+        }
+
+        //* carries
+        for (auto k = 0; k + 1 < R; ++k)
+        {
+            pos[k + 1] = _mm256_add_epi64(pos[k + 1], _mm256_srli_epi64(pos[k], limb_bits));
+            neg[k + 1] = _mm256_add_epi64(neg[k + 1], _mm256_srli_epi64(neg[k], limb_bits));
+            pos[k] = _mm256_and_si256(pos[k], limb_mask);
+            neg[k] = _mm256_and_si256(neg[k], limb_mask);
+        }
+
+        //* compare the sums from the most significant limb
+        auto greater = _mm256_setzero_si256();
+        auto less = _mm256_setzero_si256();
+        auto undecided = _mm256_set1_epi64x(-1);
+        for (auto k = R - 1; k >= 0; --k)
+        {
+            auto const gt = _mm256_cmpgt_epi64(pos[k], neg[k]);
+            auto const lt = _mm256_cmpgt_epi64(neg[k], pos[k]);
+            greater = _mm256_or_si256(greater, _mm256_and_si256(undecided, gt));
+            less = _mm256_or_si256(less, _mm256_and_si256(undecided, lt));
+            undecided = _mm256_andnot_si256(_mm256_or_si256(gt, lt), undecided);
+        }
+
+        //* sign(d) * sign(w)
+        auto const w_negative = _mm256_loadu_si256((__m256i const*)(negative + 3 * stride + i));
+        auto const w_is_zero = _mm256_loadu_si256((__m256i const*)(w_zero + i));
+        auto const result_pos = _mm256_andnot_si256(w_is_zero, _mm256_or_si256(_mm256_andnot_si256(w_negative, greater), _mm256_and_si256(w_negative, less)));
+        auto const result_neg = _mm256_andnot_si256(w_is_zero, _mm256_or_si256(_mm256_andnot_si256(w_negative, less), _mm256_and_si256(w_negative, greater)));
+        auto const result = _mm256_sub_epi64(_mm256_and_si256(result_pos, one), _mm256_and_si256(result_neg, one));
+
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256((__m256i*)lanes, result);
+        for (size_t l = 0; l < 4 && i + l < n; ++l)
+            out[i + l] = tg::i8(lanes[l]);
+    }
+}
+
+template <class geometry_t>
+__attribute__((target("avx512f,avx512ifma"))) void classify_avx512_ifma(
+    uint64_t const* limbs, uint64_t const* negative, uint64_t const* w_zero, size_t stride, size_t n, plane<geometry_t> const& p, tg::i8* out)
+{
+    static constexpr int limb_bits = 52;
+    using layout = batch_layout<geometry_t, limb_bits>;
+    static constexpr int R = layout::result_limbs;
+
+    auto const pl = split_plane<geometry_t, limb_bits>(p);
+    __m512i q[4][layout::max_coef_limbs];
+    for (auto c = 0; c < 4; ++c)
+        for (auto l = 0; l < layout::coef_limbs(c); ++l)
+            q[c][l] = _mm512_set1_epi64(int64_t(pl.limbs[c][l]));
+
+    auto const limb_mask = _mm512_set1_epi64((int64_t(1) << limb_bits) - 1);
+
+    for (size_t i = 0; i < n; i += 8)
+    {
+        __m512i pos[R], neg[R];
+        for (auto k = 0; k < R; ++k)
+            pos[k] = neg[k] = _mm512_setzero_si512();
+
+        //* 104 bit partial products: low 52 bits into column a + b, high 52 bits into column a + b + 1
+        for (auto c = 0; c < 4; ++c)
+        {
+            auto lane_negative = _mm512_test_epi64_mask(_mm512_loadu_si512(negative + c * stride + i), _mm512_set1_epi64(-1));
+            if (pl.negative[c])
+                lane_negative = __mmask8(~lane_negative);
+            auto const lane_positive = __mmask8(~lane_negative);
+
+            for (auto a = 0; a < layout::point_limbs(c); ++a)
+            {
+                auto const pa = _mm512_loadu_si512(limbs + (layout::point_row(c) + a) * stride + i);
+                for (auto b = 0; b < layout::coef_limbs(c); ++b)
+                {
+                    pos[a + b] = _mm512_mask_madd52lo_epu64(pos[a + b], lane_positive, pa, q[c][b]);
+                    neg[a + b] = _mm512_mask_madd52lo_epu64(neg[a + b], lane_negative, pa, q[c][b]);
+                    pos[a + b + 1] = _mm512_mask_madd52hi_epu64(pos[a + b + 1], lane_positive, pa, q[c][b]);
+                    neg[a + b + 1] = _mm512_mask_madd52hi_epu64(neg[a + b + 1], lane_negative, pa, q[c][b]);
+                }
+            }
+        }
+
+        //* carries
+        for (auto k = 0; k + 1 < R; ++k)
+        {
+            pos[k + 1] = _mm512_add_epi64(pos[k + 1], _mm512_srli_epi64(pos[k], limb_bits));
+            neg[k + 1] = _mm512_add_epi64(neg[k + 1], _mm512_srli_epi64(neg[k], limb_bits));
+            pos[k] = _mm512_and_si512(pos[k], limb_mask);
+            neg[k] = _mm512_and_si512(neg[k], limb_mask);
+        }
+
+        //* compare the sums from the most significant limb
+        __mmask8 greater = 0;
+        __mmask8 less = 0;
+        __mmask8 undecided = 0xFF;
+        for (auto k = R - 1; k >= 0; --k)
+        {
+            auto const gt = _mm512_cmpgt_epu64_mask(pos[k], neg[k]);
+            auto const lt = _mm512_cmplt_epu64_mask(pos[k], neg[k]);
+            greater |= undecided & gt;
+            less |= undecided & lt;
+            undecided &= __mmask8(~(gt | lt));
+        }
+
+        //* sign(d) * sign(w)
+        auto const w_negative = _mm512_test_epi64_mask(_mm512_loadu_si512(negative + 3 * stride + i), _mm512_set1_epi64(-1));
+        auto const w_nonzero = __mmask8(~_mm512_test_epi64_mask(_mm512_loadu_si512(w_zero + i), _mm512_set1_epi64(-1)));
+        auto const result_pos = __mmask8(w_nonzero & ((~w_negative & greater) | (w_negative & less)));
+        auto const result_neg = __mmask8(w_nonzero & ((~w_negative & less) | (w_negative & greater)));
+
+        for (size_t l = 0; l < 8 && i + l < n; ++l)
+            out[i + l] = tg::i8(((result_pos >> l) & 1) - ((result_neg >> l) & 1));
+    }
+}
+
+#endif
+}
+
+/// many point4 in a lane-parallel limb layout (structure of arrays, one row per limb)
+/// the conversion is done once in assign(), classify() can then be called for any number of planes
+/// every backend gives exactly the result of the scalar classify(point4, plane)
+template <class geometry_t>
+class point4_batch
+{
+public:
+    using point4_t = point4<geometry_t>;
+    using plane_t = plane<geometry_t>;
+
+    explicit point4_batch(batch_backend backend = best_batch_backend()) : m_backend(is_supported(backend) ? backend : batch_backend::scalar) {}
+
+    batch_backend backend() const { return m_backend; }
+    size_t size() const { return m_size; }
+
+    void assign(cc::span<point4_t const> points)
+    {
+        m_size = points.size();
+        switch (m_backend)
+        {
+        case batch_backend::avx2:
+            assign_limbs<28>(points, 4);
+            break;
+        case batch_backend::avx512_ifma:
+            assign_limbs<52>(points, 8);
+            break;
+        default:
+            m_points.assign(points.begin(), points.end());
+            break;
+        }
+    }
+
+    /// out[i] = classify(points[i], p), out.size() must be at least size()
+    void classify(plane_t const& p, cc::span<tg::i8> out) const
+    {
+        CC_ASSERT(out.size() >= m_size);
+        switch (m_backend)
+        {
+#if IPG_BATCH_X86
+        case batch_backend::avx2:
+            detail::classify_avx2<geometry_t>(m_limbs.data(), m_negative.data(), m_w_zero.data(), m_stride, m_size, p, out.data());
+            break;
+        case batch_backend::avx512_ifma:
+            detail::classify_avx512_ifma<geometry_t>(m_limbs.data(), m_negative.data(), m_w_zero.data(), m_stride, m_size, p, out.data());
+            break;
+#endif
+        default:
+            for (size_t i = 0; i < m_size; ++i)
+                out[i] = ipg::classify(m_points[i], p);
+            break;
+        }
+    }
+
+private:
+    template <int limb_bits>
+    void assign_limbs(cc::span<point4_t const> points, size_t lanes)
+    {
+        using layout = detail::batch_layout<geometry_t, limb_bits>;
+
+        // padding lanes are zero: they classify as 0 and are never written out
+        m_stride = (points.size() + lanes - 1) / lanes * lanes;
+        m_limbs.assign(layout::point_rows * m_stride, 0);
+        m_negative.assign(4 * m_stride, 0);
+        m_w_zero.assign(m_stride, 0);
+
+        uint64_t words[4];
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+            auto const& pt = points[i];
+            for (auto c = 0; c < 4; ++c)
+            {
+                auto const negative = c < 3 ? detail::magnitude_words(pt.comp(c), words) : detail::magnitude_words(pt.w, words);
+                m_negative[c * m_stride + i] = negative ? ~uint64_t(0) : 0;
+                for (auto l = 0; l < layout::point_limbs(c); ++l)
+                    m_limbs[(layout::point_row(c) + l) * m_stride + i] = detail::extract_limb(words, limb_bits, l);
+            }
+            m_w_zero[i] = pt.is_valid() ? 0 : ~uint64_t(0);
+        }
+    }
+
+private:
+    batch_backend m_backend;
+    size_t m_size = 0;
+    size_t m_stride = 0;
+
+    std::vector<uint64_t> m_limbs;    // row (point_row(c) + limb) * m_stride + point
+    std::vector<uint64_t> m_negative; // all bits set if the coordinate is negative, row c * m_stride + point
+    std::vector<uint64_t> m_w_zero;   // all bits set if w is zero
+    std::vector<point4_t> m_points;   // scalar backend only
+};
+
+/// out[i] = classify(points[i], p) with the given backend (falls back to scalar if unsupported)
+template <class geometry_t>
+void classify_batch(cc::span<point4<geometry_t> const> points, plane<geometry_t> const& p, cc::span<tg::i8> out, batch_backend backend = best_batch_backend())
+{
+    point4_batch<geometry_t> batch(backend);
+    batch.assign(points);
+    batch.classify(p, out);
+}
+}
@@ -56,8 +56,9 @@ fixed_int<bits_out> mul(A a, B b)
     // round to next 64bit
     auto constexpr words_out = (bits_out + 63) / 64;
 
+    // widen before multiplying, otherwise two 32 bit factors overflow in 32 bit
     if constexpr (words_out == 1)
-        return a * b;
+        return fixed_int<bits_out>(a) * fixed_int<bits_out>(b);
     else if constexpr (sizeof(a) <= 8 && sizeof(b) <= 8)
         return tg::detail::imul<words_out>(tg::i64(a), tg::i64(b));
     else if constexpr (sizeof(a) <= 8)
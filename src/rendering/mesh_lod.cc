@@ -0,0 +1,146 @@
+#include "mesh_lod.hh"
+
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <clean-core/array.hh>
+
+#include <typed-geometry/tg.hh>
+
+namespace
+{
+struct triangle_hash
+{
+    size_t operator()(cc::array<int, 3> const& t) const
+    {
+        auto h = size_t(t[0]);
+        h = h * 0x9E3779B97F4A7C15ull ^ size_t(t[1]);
+        h = h * 0x9E3779B97F4A7C15ull ^ size_t(t[2]);
+        return h;
+    }
+};
+
+struct triangle_equal
+{
+    bool operator()(cc::array<int, 3> const& a, cc::array<int, 3> const& b) const { return a[0] == b[0] && a[1] == b[1] && a[2] == b[2]; }
+};
+}
+
+bool mk::cluster_vertices(pm::vertex_attribute<tg::dpos3> const& position, int grid_resolution, lod_level& level, std::atomic<bool> const* cancelled)
+{
+    auto const& mesh = position.mesh();
+    auto const is_cancelled = [&] { return cancelled && cancelled->load(std::memory_order_relaxed); };
+
+    auto const aabb = tg::aabb_of(mesh.vertices(), position);
+    auto const extent = tg::max_element(aabb.max - aabb.min);
+    auto const res = tg::max(1, grid_resolution);
+    auto const cell_size = extent > 0 ? extent / res : 1.0;
+
+    //* cluster the vertices
+    std::unordered_map<int64_t, int> cluster_of_cell;
+    std::vector<tg::dvec3> cluster_sum;
+    std::vector<int> cluster_count;
+    pm::vertex_attribute<int> cluster_of_vertex(mesh);
+
+    for (auto const v : mesh.vertices())
+    {
+        auto const rel = (position[v] - aabb.min) / cell_size;
+        auto const ix = tg::clamp(int64_t(rel.x), int64_t(0), int64_t(res));
+        auto const iy = tg::clamp(int64_t(rel.y), int64_t(0), int64_t(res));
+        auto const iz = tg::clamp(int64_t(rel.z), int64_t(0), int64_t(res));
+        auto const key = (ix * (res + 1) + iy) * (res + 1) + iz;
+
+        auto const [it, inserted] = cluster_of_cell.emplace(key, int(cluster_sum.size()));
+        if (inserted)
+        {
+            cluster_sum.push_back(tg::dvec3::zero);
+            cluster_count.push_back(0);
+        }
+        cluster_sum[it->second] += tg::dvec3(position[v]);
+        cluster_count[it->second]++;
+        cluster_of_vertex[v] = it->second;
+    }
+
+    if (is_cancelled())
+        return false;
+
+    //* collect the surviving triangles (faces are fan triangulated)
+    std::unordered_set<cc::array<int, 3>, triangle_hash, triangle_equal> seen;
+    std::vector<cc::array<int, 3>> triangles;
+    auto face_count = 0;
+    for (auto const f : mesh.faces())
+    {
+        if (++face_count % 65536 == 0 && is_cancelled())
+            return false;
+
+        auto const he0 = f.any_halfedge();
+        auto const c0 = cluster_of_vertex[he0.vertex_from()];
+        for (auto he = he0.next(); he.vertex_to() != he0.vertex_from(); he = he.next())
+        {
+            auto const c1 = cluster_of_vertex[he.vertex_from()];
+            auto const c2 = cluster_of_vertex[he.vertex_to()];
+            if (c0 == c1 || c1 == c2 || c0 == c2)
+                continue;
+
+            // orientation independent key: rotate the smallest index to the front and sort the other two
+            cc::array<int, 3> key = {c0, c1, c2};
+            if (key[1] < key[0] && key[1] <= key[2])
+                key = {key[1], key[2], key[0]};
+            else if (key[2] < key[0] && key[2] < key[1])
+                key = {key[2], key[0], key[1]};
+            if (key[2] < key[1])
+                std::swap(key[1], key[2]);
+
+            if (seen.insert(key).second)
+                triangles.push_back({c0, c1, c2});
+        }
+    }
+
+    //* triangle soup
+    level.mesh.clear();
+    level.position = pm::vertex_attribute<tg::dpos3>(level.mesh);
+    level.grid_resolution = res;
+    level.mesh.vertices().reserve(triangles.size() * 3);
+    level.mesh.faces().reserve(triangles.size());
+
+    for (auto const& t : triangles)
+    {
+        pm::vertex_handle vs[3];
+        for (auto i = 0; i < 3; ++i)
+        {
+            vs[i] = level.mesh.vertices().add();
+            level.position[vs[i]] = tg::dpos3(cluster_sum[t[i]] / double(cluster_count[t[i]]));
+        }
+        level.mesh.faces().add(vs[0], vs[1], vs[2]);
+    }
+
+    return true;
+}
+
+std::shared_ptr<mk::mesh_lod> mk::build_mesh_lod(pm::vertex_attribute<tg::dpos3> const& position, int min_faces, std::atomic<bool> const* cancelled)
+{
+    auto lod = std::make_shared<mesh_lod>();
+    lod->source_faces = int(position.mesh().faces().size());
+
+    // a closed surface touches roughly 6 * res^2 cells (about 12 * res^2 triangles), start at about half the face count
+    auto res = tg::max(8, int(std::sqrt(lod->source_faces / 24.0)));
+    auto previous_faces = lod->source_faces;
+
+    while (previous_faces > min_faces && res >= 4)
+    {
+        auto level = std::make_unique<lod_level>();
+        if (!cluster_vertices(position, res, *level, cancelled))
+            return nullptr;
+
+        auto const faces = int(level->mesh.faces().size());
+        if (faces <= previous_faces * 3 / 4)
+        {
+            previous_faces = faces;
+            lod->levels.push_back(std::move(level));
+        }
+        res /= 2;
+    }
+
+    return lod;
+}
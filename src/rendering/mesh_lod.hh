@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <polymesh/Mesh.hh>
+
+#include <typed-geometry/tg-lean.hh>
+
+namespace mk
+{
+/// one simplified version of a mesh for display only
+/// the triangles do not share vertices (clustering creates non-manifold configurations that pm::Mesh cannot represent)
+struct lod_level
+{
+    pm::Mesh mesh;
+    pm::vertex_attribute<tg::dpos3> position{mesh};
+    int grid_resolution = 0;
+};
+
+/// levels of detail of a mesh, levels[0] is the finest
+struct mesh_lod
+{
+    std::vector<std::unique_ptr<lod_level>> levels;
+    int source_faces = 0;
+};
+
+/// vertex clustering: all vertices in a cell of a uniform grid with grid_resolution cells along the longest aabb axis
+/// are merged into their average, triangles that collapse or occur twice are dropped
+/// returns false if cancelled
+bool cluster_vertices(pm::vertex_attribute<tg::dpos3> const& position, int grid_resolution, lod_level& level, std::atomic<bool> const* cancelled = nullptr);
+
+/// builds levels of decreasing resolution (halving the grid) until a level has at most min_faces faces
+/// levels that remove less than a quarter of the faces of the previous level are skipped
+/// returns nullptr if cancelled
+std::shared_ptr<mesh_lod> build_mesh_lod(pm::vertex_attribute<tg::dpos3> const& position, int min_faces = 20'000, std::atomic<bool> const* cancelled = nullptr);
+}
@@ -19,6 +19,7 @@ public: // types
         cc::string name;
         cc::vector<glow::viewer::SharedRenderable> renderables;
         bool is_enabled = true;
+        bool needs_rebuild = false; // content changed, renderables are only (re)built while the group is enabled
     };
 
 public: // adding renderables